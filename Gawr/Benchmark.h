@@ -0,0 +1,147 @@
+#pragma once
+#include "Gawr/Components/Hierarchy.h"
+#include "Gawr/Components/Extraction.h"
+
+#include <chrono>
+#include <ostream>
+
+// compares the world transform techniques on a deep hierarchy (long chains) and a wide hierarchy (few roots with many
+// children). every root is tagged each iteration so the whole hierarchy is updated.
+namespace Benchmark {
+	namespace internal {
+		template<typename Pip_T>
+		Gawr::ECS::Entity createTransform(Pip_T& pipeline) {
+			using namespace Transform;
+
+			Gawr::ECS::Entity e = pipeline.template pool<Gawr::ECS::Entity>().create();
+			pipeline.template pool<Position>().emplace(e, glm::vec3(1.0f, 0.0f, 0.0f));
+			pipeline.template pool<Rotation>().emplace(e, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+			pipeline.template pool<Scale>().emplace(e, glm::vec3(1.0f));
+			pipeline.template pool<Local>().emplace(e, glm::mat4(1.0f));
+			pipeline.template pool<World>().emplace(e, glm::mat4(1.0f));
+			pipeline.template pool<WorldPosition>().emplace(e, glm::vec3(0.0f));
+			pipeline.template pool<WorldRotation>().emplace(e, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+			pipeline.template pool<WorldScale>().emplace(e, glm::vec3(1.0f));
+			return e;
+		}
+
+		/// @param branching children per entity, 1 builds chains
+		inline std::vector<Gawr::ECS::Entity> build(Scene& scene, size_t roots, size_t depth, size_t branching) {
+			using namespace Gawr::ECS;
+			using namespace Transform;
+
+			auto pipeline = scene.pipeline<Entity, Parent, Children, Position, Rotation, Scale, Local, World, WorldPosition, WorldRotation, WorldScale>();
+
+			std::vector<Entity> result;
+			for (size_t r = 0; r < roots; r++)
+			{
+				std::vector<Entity> level{ createTransform(pipeline) };
+				result.push_back(level[0]);
+
+				for (size_t d = 0; d < depth; d++)
+				{
+					std::vector<Entity> next;
+					for (Entity parent : level)
+					{
+						for (size_t b = 0; b < branching; b++)
+						{
+							Entity child = createTransform(pipeline);
+							setParent(pipeline, child, parent);
+							next.push_back(child);
+						}
+					}
+					level = std::move(next);
+				}
+			}
+			return result;
+		}
+
+		/// @return average milliseconds per update
+		inline double measure(Scene& scene, const std::vector<Gawr::ECS::Entity>& roots, TransformMode mode, size_t iterations) {
+			using namespace Gawr::ECS;
+			using namespace Transform;
+
+			// scratch from a double buffered frame allocator, as in the application frame loop
+			FrameAllocator frames(2, 1);
+
+			double total = 0.0;
+			for (size_t i = 0; i < iterations; i++)
+			{
+				{
+					auto pipeline = scene.pipeline<UpdateTag>();
+					auto& updatePool = pipeline.pool<UpdateTag>();
+					while (updatePool.size() > 0)
+						updatePool.erase(updatePool.size() - 1);
+
+					for (Entity root : roots)
+						updatePool.emplace(root);
+				}
+
+				frames.beginFrame(i);
+
+				auto begin = std::chrono::high_resolution_clock::now();
+				updateWorldTransform(scene, mode, frames.resource());
+				total += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+			}
+			return total / iterations;
+		}
+	}
+
+	inline void transforms(std::ostream& out, size_t iterations = 20) {
+		struct Case { const char* name; size_t roots, depth, branching; };
+		const Case cases[] = {
+			{ "deep (64 chains x 1024)",		64,  1024, 1 },
+			{ "wide (4 roots x 128 x 128)",	4,   2,    128 },
+		};
+
+		const std::pair<const char*, TransformMode> modes[] = {
+			{ "matrix",				TransformMode::Matrix },
+			{ "matrix parallel",	TransformMode::MatrixParallel },
+			{ "hybrid",				TransformMode::Hybrid },
+		};
+
+		for (auto& c : cases)
+		{
+			Scene scene;
+			auto roots = internal::build(scene, c.roots, c.depth, c.branching);
+			updateHierarchy(scene);
+
+			out << c.name << '\n';
+			for (auto [name, mode] : modes)
+				out << "\t" << name << ": " << internal::measure(scene, roots, mode, iterations) << " ms\n";
+		}
+	}
+
+	/// @brief extracts a wide hierarchy where every entity is renderable into a double buffered frame packet.
+	inline void extraction(std::ostream& out, size_t iterations = 20) {
+		using namespace Gawr::ECS;
+
+		Scene scene;
+		internal::build(scene, 4, 2, 256);
+		updateHierarchy(scene);
+		updateWorldTransform(scene);
+
+		size_t count = 0;
+		{
+			auto pipeline = scene.pipeline<const Entity, Mesh::Renderable>();
+			for (Entity e : pipeline.pool<const Entity>())
+				pipeline.pool<Mesh::Renderable>().emplace(e, Mesh::Renderable{ e % 16, e % 4 });
+			count = pipeline.pool<Mesh::Renderable>().size();
+		}
+
+		Render::FramePacketBuffer<> packets;
+		double total = 0.0;
+		for (size_t i = 0; i < iterations; i++)
+		{
+			auto begin = std::chrono::high_resolution_clock::now();
+			extractRenderables(scene, packets.beginWrite(), i);
+			packets.publish();
+			total += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+
+			packets.acquire();
+			packets.release();
+		}
+
+		out << "extraction (" << count << " renderables): " << total / iterations << " ms\n";
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GAWR_X86
+#include <immintrin.h>
+#endif
+
+namespace Transform {
+	/// @brief a row major 3x4 matrix, the implicit last row of a TRS transform is (0, 0, 0, 1). 48 bytes rather than the 64 of
+	/// a mat4, expanded only where a full matrix is needed eg uploading to the gpu.
+	struct alignas(16) Affine {
+		glm::vec4 m_rows[3];
+
+		Affine() : m_rows{ { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 } } { }
+
+		explicit Affine(const glm::mat4& m) : m_rows{
+			{ m[0][0], m[1][0], m[2][0], m[3][0] },
+			{ m[0][1], m[1][1], m[2][1], m[3][1] },
+			{ m[0][2], m[1][2], m[2][2], m[3][2] } }
+		{ }
+
+		explicit operator glm::mat4() const {
+			return glm::mat4(
+				glm::vec4(m_rows[0][0], m_rows[1][0], m_rows[2][0], 0.0f),
+				glm::vec4(m_rows[0][1], m_rows[1][1], m_rows[2][1], 0.0f),
+				glm::vec4(m_rows[0][2], m_rows[1][2], m_rows[2][2], 0.0f),
+				glm::vec4(m_rows[0][3], m_rows[1][3], m_rows[2][3], 1.0f));
+		}
+
+		glm::vec3 translation() const {
+			return glm::vec3(m_rows[0][3], m_rows[1][3], m_rows[2][3]);
+		}
+
+		glm::vec3 transformPoint(const glm::vec3& p) const {
+			return glm::vec3(
+				m_rows[0][0] * p.x + m_rows[0][1] * p.y + m_rows[0][2] * p.z + m_rows[0][3],
+				m_rows[1][0] * p.x + m_rows[1][1] * p.y + m_rows[1][2] * p.z + m_rows[1][3],
+				m_rows[2][0] * p.x + m_rows[2][1] * p.y + m_rows[2][2] * p.z + m_rows[2][3]);
+		}
+
+		friend Affine operator*(const Affine& a, const Affine& b) {
+			Affine result;
+#if defined(GAWR_X86)
+			// row i = a[i].x * b[0] + a[i].y * b[1] + a[i].z * b[2] + (0, 0, 0, a[i].w)
+			const __m128 w = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+			__m128 b0 = _mm_load_ps(&b.m_rows[0][0]), b1 = _mm_load_ps(&b.m_rows[1][0]), b2 = _mm_load_ps(&b.m_rows[2][0]);
+
+			for (int i = 0; i < 3; i++)
+			{
+				__m128 row = _mm_load_ps(&a.m_rows[i][0]);
+				__m128 r = _mm_and_ps(row, w);
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(0, 0, 0, 0)), b0));
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+				_mm_store_ps(&result.m_rows[i][0], r);
+			}
+#else
+			for (int i = 0; i < 3; i++)
+			{
+				const glm::vec4& row = a.m_rows[i];
+				result.m_rows[i] = b.m_rows[0] * row.x + b.m_rows[1] * row.y + b.m_rows[2] * row.z + glm::vec4(0.0f, 0.0f, 0.0f, row.w);
+			}
+#endif
+			return result;
+		}
+
+		/// @brief inverts the linear part with cofactors and the translation with the inverted linear part.
+		friend Affine inverse(const Affine& m) {
+			Affine result;
+#if defined(GAWR_X86)
+			auto cross = [](__m128 u, __m128 v) {
+				__m128 uyzx = _mm_shuffle_ps(u, u, _MM_SHUFFLE(3, 0, 2, 1)), vyzx = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1));
+				__m128 c = _mm_sub_ps(_mm_mul_ps(u, vyzx), _mm_mul_ps(uyzx, v));
+				return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+			};
+
+			// columns of the linear part, the last column is the translation
+			__m128 c0 = _mm_load_ps(&m.m_rows[0][0]), c1 = _mm_load_ps(&m.m_rows[1][0]), c2 = _mm_load_ps(&m.m_rows[2][0]), t = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(c0, c1, c2, t);
+
+			// rows of the inverse are the cross products of the columns over the determinant
+			__m128 r0 = cross(c1, c2), r1 = cross(c2, c0), r2 = cross(c0, c1);
+
+			__m128 det = _mm_mul_ps(c0, r0);
+			det = _mm_add_ps(_mm_shuffle_ps(det, det, _MM_SHUFFLE(0, 0, 0, 0)), _mm_add_ps(_mm_shuffle_ps(det, det, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(det, det, _MM_SHUFFLE(2, 2, 2, 2))));
+			__m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+			__m128 rows[3] = { _mm_mul_ps(r0, invDet), _mm_mul_ps(r1, invDet), _mm_mul_ps(r2, invDet) };
+			for (int i = 0; i < 3; i++)
+			{
+				_mm_store_ps(&result.m_rows[i][0], rows[i]);
+
+				glm::vec4& row = result.m_rows[i];
+				row.w = -(row.x * _mm_cvtss_f32(t) + row.y * _mm_cvtss_f32(_mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))) + row.z * _mm_cvtss_f32(_mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+			}
+#else
+			glm::vec3 c0(m.m_rows[0][0], m.m_rows[1][0], m.m_rows[2][0]);
+			glm::vec3 c1(m.m_rows[0][1], m.m_rows[1][1], m.m_rows[2][1]);
+			glm::vec3 c2(m.m_rows[0][2], m.m_rows[1][2], m.m_rows[2][2]);
+			glm::vec3 t = m.translation();
+
+			float invDet = 1.0f / glm::dot(c0, glm::cross(c1, c2));
+			glm::vec3 rows[3] = { glm::cross(c1, c2) * invDet, glm::cross(c2, c0) * invDet, glm::cross(c0, c1) * invDet };
+			for (int i = 0; i < 3; i++)
+				result.m_rows[i] = glm::vec4(rows[i], -glm::dot(rows[i], t));
+#endif
+			return result;
+		}
+	};
+
+	static_assert(sizeof(Affine) == 48, "affine matrix should be 3 rows of 4 floats");
+}
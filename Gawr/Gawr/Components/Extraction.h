@@ -0,0 +1,191 @@
+#pragma once
+#include "Hierarchy.h"
+#include "../ECS/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Render {
+	/// @brief everything the renderer needs to draw a frame, copied out of the scene so the render thread never touches the
+	/// registry. instance i is drawn with m_world[i] and m_renderables[i], the arrays are flat so they can be uploaded as is.
+	struct FramePacket {
+		uint64_t						m_frame = 0;	// simulation frame extracted
+		std::chrono::steady_clock::time_point	m_time;	// when the frame was scheduled, eg to interpolate between packets
+		std::vector<Gawr::ECS::Entity>	m_entities;
+		std::vector<Transform::Affine>	m_world;
+		std::vector<Mesh::Renderable>	m_renderables;
+
+		size_t size() const {
+			return m_entities.size();
+		}
+	};
+
+	/// @brief frame packets shared by the simulation and render threads. the simulation writes one packet while the render
+	/// thread reads the latest Depth published, so rendering frame N overlaps simulating frame N + 1. the writer never
+	/// waits: it writes a packet neither held by the render thread nor among the latest published, and if there is none, 
+	/// eg the default double buffer while the render thread holds a packet and the other waits, it overwrites the oldest
+	/// published packet not held, so a slow render thread skips to the newest frame. a single thread writes and a single
+	/// thread reads.
+	/// @tparam Slots packets in the buffer, with 2 * Depth + 1 a published packet is never overwritten
+	/// @tparam Depth packets the render thread reads at once, eg 2 to interpolate between the latest two
+	template<size_t Slots = 2, size_t Depth = 1>
+	class FramePacketBuffer {
+		static_assert(Depth > 0 && Slots > Depth, "the writer needs a packet the render thread cannot hold");
+
+		static constexpr int none = -1;
+
+	public:
+		FramePacketBuffer() {
+			m_published.fill(none);
+			m_held.fill(none);
+		}
+
+		FramePacketBuffer(const FramePacketBuffer&) = delete;
+		FramePacketBuffer& operator=(const FramePacketBuffer&) = delete;
+
+		/// @brief the packet to extract the next frame into. its arrays keep their capacity between frames so extraction
+		/// stops allocating once the scene stops growing.
+		FramePacket& beginWrite() {
+			std::lock_guard guard(m_mtx);
+			m_writing = none;
+			for (int slot = 0; slot < int(Slots) && m_writing == none; slot++)
+			{
+				if (!held(slot) && std::find(m_published.begin(), m_published.end(), slot) == m_published.end())
+					m_writing = slot;
+			}
+
+			// overwriting a packet the render thread never acquired
+			for (size_t i = 0; i < Depth && m_writing == none; i++)
+			{
+				if (m_published[i] != none && !held(m_published[i]))
+				{
+					m_writing = m_published[i];
+					std::shift_right(m_published.begin(), m_published.begin() + i + 1, 1);
+					m_published[0] = none;
+					if (i == Depth - 1)
+						m_unread = false;
+				}
+			}
+
+			return m_packets[m_writing];
+		}
+
+		/// @brief makes the packet written since beginWrite the newest for the render thread.
+		void publish() {
+			{
+				std::lock_guard guard(m_mtx);
+				std::shift_left(m_published.begin(), m_published.end(), 1);
+				m_published[Depth - 1] = m_writing;
+				m_writing = none;
+				m_unread = true;
+			}
+			m_wake.notify_one();
+		}
+
+		/// @brief blocks until a packet newer than the last acquired is published, it is read only until release.
+		/// @return nullptr once the buffer is closed
+		const FramePacket* acquire() {
+			std::unique_lock lock(m_mtx);
+			m_wake.wait(lock, [&]() { return m_unread || m_closed; });
+			if (!m_unread)
+				return nullptr;
+
+			m_held.fill(none);
+			m_held[0] = m_published[Depth - 1];
+			m_unread = false;
+			return &m_packets[m_held[0]];
+		}
+
+		/// @brief the latest Depth packets oldest first, read only until release. never blocks on the writer.
+		/// @return nullptr in place of the oldest packets until Depth have been published
+		std::array<const FramePacket*, Depth> acquireLatest() {
+			std::lock_guard guard(m_mtx);
+			m_held = m_published;
+			m_unread = false;
+
+			std::array<const FramePacket*, Depth> packets;
+			for (size_t i = 0; i < Depth; i++)
+				packets[i] = m_held[i] == none ? nullptr : &m_packets[m_held[i]];
+			return packets;
+		}
+
+		void release() {
+			std::lock_guard guard(m_mtx);
+			m_held.fill(none);
+		}
+
+		/// @brief wakes the render thread with nullptr from acquire, eg when the application is closing.
+		void close() {
+			{
+				std::lock_guard guard(m_mtx);
+				m_closed = true;
+			}
+			m_wake.notify_all();
+		}
+
+	private:
+		bool held(int slot) const {
+			return std::find(m_held.begin(), m_held.end(), slot) != m_held.end();
+		}
+
+		std::array<FramePacket, Slots>	m_packets;
+		std::mutex						m_mtx;
+		std::condition_variable			m_wake;
+		std::array<int, Depth>			m_published;	// oldest first, none before the first publish
+		std::array<int, Depth>			m_held;			// by the render thread
+		int								m_writing = none;
+		bool							m_unread = false;	// the newest published has not been acquired
+		bool							m_closed = false;
+	};
+}
+
+/// @brief copies the world matrix, mesh and material of every renderable entity into packet, entities without a world
+/// transform are skipped. the renderables are split into chunks copied in parallel, each chunk counts its instances then
+/// writes them after the instances of the earlier chunks, so the packet is tightly packed in pool order. acquires read
+/// access to the world and renderable pools.
+/// @param frame stored in the packet, eg the simulation frame counter
+inline void extractRenderables(Scene& scene, Render::FramePacket& packet, uint64_t frame) {
+	using namespace Gawr::ECS;
+	using namespace Transform;
+
+	auto pipeline = scene.pipeline<const World, const Mesh::Renderable>();
+	auto& worldPool = pipeline.pool<const World>();
+	auto& renderPool = pipeline.pool<const Mesh::Renderable>();
+
+	size_t count = renderPool.size();
+	size_t chunks = internal::chunkCount(count);
+
+	// count then exclusive prefix sum, chunk boundaries are the same in both passes
+	std::vector<size_t> offsets(chunks + 1, 0);
+	internal::parallelChunks(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			offsets[chunk + 1] += worldPool.contains(renderPool.at(i));
+	});
+	for (size_t chunk = 0; chunk < chunks; chunk++)
+		offsets[chunk + 1] += offsets[chunk];
+
+	packet.m_frame = frame;
+	packet.m_entities.resize(offsets[chunks]);
+	packet.m_world.resize(offsets[chunks]);
+	packet.m_renderables.resize(offsets[chunks]);
+
+	internal::parallelChunks(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+		size_t out = offsets[chunk];
+		for (size_t i = begin; i < end; i++)
+		{
+			Entity e = renderPool.at(i);
+			if (!worldPool.contains(e))
+				continue;
+
+			packet.m_entities[out] = e;
+			packet.m_world[out] = worldPool.getComponent(e).m_matrix;
+			packet.m_renderables[out] = renderPool.getComponent(e);
+			out++;
+		}
+	});
+}
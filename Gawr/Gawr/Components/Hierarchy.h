@@ -1,38 +1,72 @@
 #pragma once
 #include "../Scene.h"
+#include "../ECS/Scheduler.h"
+
+#include <algorithm>
+#include <barrier>
+#include <iterator>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <thread>
 
 struct Parent {
 	Gawr::ECS::Entity m_parent;
+	uint32_t m_depth = 0;	// number of ancestors with a parent, ie 0 when parent is a root
+	Gawr::ECS::Entity m_prev = Gawr::ECS::tombstone;	// previous sibling
+	Gawr::ECS::Entity m_next = Gawr::ECS::tombstone;	// next sibling
 	operator Gawr::ECS::Entity() const { return m_parent; }
 
+	void remap(const Gawr::ECS::EntityRemap& remap) {
+		m_parent = remap(m_parent);
+		m_prev = remap(m_prev);
+		m_next = remap(m_next);
+	}
+};
+
+/// @brief the head of an entity's child list, the list is linked through each child's Parent component.
+struct Children {
+	Gawr::ECS::Entity m_first = Gawr::ECS::tombstone;
+	uint32_t m_count = 0;
+
+	void remap(const Gawr::ECS::EntityRemap& remap) {
+		m_first = remap(m_first);
+	}
 };
 
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include "TransformKernel.h"
 
 namespace Transform {
 	struct Local {
-		glm::mat4 m_matrix;
+		Affine m_matrix;
+		Local(const Affine& m) : m_matrix(m) { }
 		Local(const glm::mat4& m) : m_matrix(m) { }
-		operator const glm::mat4& () const { return m_matrix; }
+		operator const Affine&() const { return m_matrix; }
+		operator glm::mat4() const { return (glm::mat4)m_matrix; }
 	};
 	struct World {
-		glm::mat4 m_matrix;
+		Affine m_matrix;
+		World(const Affine& m) : m_matrix(m) { }
 		World(const glm::mat4& m) : m_matrix(m) { }
-		operator const glm::mat4&() const { return m_matrix; }
+		operator const Affine&() const { return m_matrix; }
+		operator glm::mat4() const { return (glm::mat4)m_matrix; }
 
-		friend glm::mat4 operator *(const World& world, const Local& local) {
+		friend Affine operator *(const World& world, const Local& local) {
 			return world.m_matrix * local.m_matrix;
 		}
 	};
 	
 	struct Position {
 	public:
+		Position(const glm::vec3& position) : m_position(position) { }
 		operator const glm::vec3&() const { return m_position; }
 		operator glm::mat4() const { return glm::translate(m_position); }
 		friend glm::mat4 operator *(const Position& pos, const Local& mat) {
-			return glm::translate(pos.m_position) * mat.m_matrix;
+			return glm::translate(pos.m_position) * (glm::mat4)mat.m_matrix;
 		}
 	private:
 		glm::vec3 m_position;
@@ -42,7 +76,7 @@ namespace Transform {
 		operator const glm::quat&() const { return m_rotation; }
 		operator glm::mat4() const { return glm::mat4_cast(m_rotation); }
 		friend glm::mat4 operator *(const Rotation& rot, const Local& mat) {
-			return glm::mat4_cast(rot.m_rotation) * mat.m_matrix;
+			return glm::mat4_cast(rot.m_rotation) * (glm::mat4)mat.m_matrix;
 		}
 	};
 	struct Scale {
@@ -50,18 +84,20 @@ namespace Transform {
 		operator const glm::vec3&() const { return m_scale; }
 		operator glm::mat4() const { return glm::scale(m_scale); }
 		friend glm::mat4 operator *(const Scale& scl, const Local& mat) {
-			return glm::scale(scl.m_scale) * mat.m_matrix;
+			return glm::scale(scl.m_scale) * (glm::mat4)mat.m_matrix;
 		}
 	};
 	
 	struct WorldPosition {
 	public:
+		WorldPosition(const glm::vec3& position) : m_position(position) { }
+
 		WorldPosition(const glm::vec3& position, const glm::vec3& worldScale, const glm::quat& worldRotation) {
-			m_position = worldRotation * (position * worldScale) * glm::conjugate(worldRotation);
+			m_position = worldRotation * (position * worldScale);
 		}
 
 		WorldPosition(const glm::vec3& parentPosition, const glm::vec3& position, const glm::vec3& worldScale, const glm::quat& worldRotation) {
-			m_position = parentPosition + worldRotation * (position * worldScale) * glm::conjugate(worldRotation);
+			m_position = parentPosition + worldRotation * (position * worldScale);
 		}
 
 		operator const glm::vec3& () const { return m_position; }
@@ -99,17 +135,28 @@ namespace Mesh {
 	class VBO { };
 
 	class VAO { };
+
+	/// @brief the mesh and material an entity is drawn with, ids into the renderer's resources.
+	struct Renderable {
+		uint32_t m_mesh;
+		uint32_t m_material;
+	};
 }
 
 struct Scene : Gawr::ECS::Registry<
 	Gawr::ECS::Entity, // entity pool
 	Parent, 
+	Children,
 	Transform::Position, 
 	Transform::Rotation, 
 	Transform::Scale, 
 	Transform::World,
 	Transform::Local,
-	Transform::UpdateTag
+	Transform::WorldPosition,
+	Transform::WorldRotation,
+	Transform::WorldScale,
+	Transform::UpdateTag,
+	Mesh::Renderable
 	//Mesh::VAO,
 	//Mesh::VBO<Mesh::Attrib::Index>,
 	//Mesh::VBO<Mesh::Attrib::Position>,
@@ -117,7 +164,9 @@ struct Scene : Gawr::ECS::Registry<
 	//Mesh::VBO<Mesh::Attrib::Tangent>,
 	//Mesh::VBO<Mesh::Attrib::TexCoord>,
 	//Mesh::VBO<Mesh::Attrib::MaterialIndex>
-> { };
+> {
+	using Registry::Registry;
+};
 
 // Maybe: calculate transform using quaternion where possible to avoid transform calculations???
 // could add an alternative to world matrix and instead use world transform object which would store a position, a quaternion and a scale
@@ -130,209 +179,925 @@ struct Scene : Gawr::ECS::Registry<
 // if I have to convert most values to matrix transforms any also likely isnt very useful
 // but for bone transforms
 
-void updateHierarchy(Scene& registry) {
+namespace Hierarchy::internal {
+	// the parent pool is ordered deepest first, as the pool iterates back to front parents are visited before their children.
+	// an entity on the boundary of two depth buckets may belong to either, so moving between buckets swaps once per bucket
+	// crossed. depth -1 is the back of the pool.
+	template<typename Pool_T>
+	void moveDepth(Pool_T& parentPool, Gawr::ECS::Entity e, int64_t from, int64_t to) {
+		auto depthAt = [&](size_t i) -> int64_t { return parentPool.getComponent(parentPool.at(i)).m_depth; };
+
+		size_t pos = parentPool.index(e);
+
+		// move towards the front, first of each deeper bucket
+		for (int64_t depth = std::max<int64_t>(from, 0); depth < to; depth++)
+		{
+			size_t first = *std::ranges::partition_point(std::views::iota(size_t{ 0 }, pos), [&](size_t i) { return depthAt(i) > depth; });
+			parentPool.swap(e, parentPool.at(first));
+			pos = first;
+		}
+
+		// move towards the back, last of each shallower bucket
+		for (int64_t depth = from; depth > to; depth--)
+		{
+			size_t last = *std::ranges::partition_point(std::views::iota(pos + 1, parentPool.size()), [&](size_t i) { return depthAt(i) >= depth; }) - 1;
+			parentPool.swap(e, parentPool.at(last));
+			pos = last;
+		}
+	}
+
+	template<typename ParentPool_T, typename ChildrenPool_T>
+	void link(ParentPool_T& parentPool, ChildrenPool_T& childrenPool, Gawr::ECS::Entity child, Gawr::ECS::Entity parent) {
+		using namespace Gawr::ECS;
+
+		if (!childrenPool.contains(parent))
+			childrenPool.emplace(parent);
+
+		Children& children = childrenPool.getComponent(parent);
+		Parent& node = parentPool.getComponent(child);
+
+		// push front
+		node.m_prev = tombstone;
+		node.m_next = children.m_first;
+		if (children.m_first != tombstone)
+		{
+			parentPool.getComponent(children.m_first).m_prev = child;
+			parentPool.update(children.m_first);
+		}
+
+		children.m_first = child;
+		children.m_count++;
+
+		parentPool.update(child);
+		childrenPool.update(parent);
+	}
+
+	template<typename ParentPool_T, typename ChildrenPool_T>
+	void unlink(ParentPool_T& parentPool, ChildrenPool_T& childrenPool, Gawr::ECS::Entity child) {
+		using namespace Gawr::ECS;
+
+		Parent& node = parentPool.getComponent(child);
+
+		if (node.m_next != tombstone)
+		{
+			parentPool.getComponent(node.m_next).m_prev = node.m_prev;
+			parentPool.update(node.m_next);
+		}
+
+		if (node.m_prev != tombstone)
+		{
+			parentPool.getComponent(node.m_prev).m_next = node.m_next;
+			parentPool.update(node.m_prev);
+		}
+
+		if (childrenPool.contains(node.m_parent))
+		{
+			Children& children = childrenPool.getComponent(node.m_parent);
+			if (children.m_first == child)
+				children.m_first = node.m_next;
+
+			if (--children.m_count == 0)
+				childrenPool.remove(node.m_parent);
+			else
+				childrenPool.update(node.m_parent);
+		}
+
+		node.m_prev = tombstone;
+		node.m_next = tombstone;
+		parentPool.update(child);
+	}
+
+	// visits the descendants of e depth first, parents before children. the traversal stack is allocated from scratch
+	template<typename ParentPool_T, typename ChildrenPool_T, typename Func_T>
+	void eachDescendant(ParentPool_T& parentPool, ChildrenPool_T& childrenPool, Gawr::ECS::Entity e, Func_T func, 
+		std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) {
+		using namespace Gawr::ECS;
+
+		std::pmr::vector<Entity> stack({ e }, scratch);
+		while (!stack.empty())
+		{
+			Entity curr = stack.back();
+			stack.pop_back();
+
+			if (!childrenPool.contains(curr))
+				continue;
+
+			for (Entity child = childrenPool.getComponent(curr).m_first; child != tombstone; child = parentPool.getComponent(child).m_next)
+			{
+				func(child);
+				stack.push_back(child);
+			}
+		}
+	}
+
+	// tagged entities without a tagged ancestor, their subtrees cover every entity that needs updating
+	template<typename ParentPool_T, typename UpdatePool_T>
+	std::pmr::vector<Gawr::ECS::Entity> dirtyRoots(ParentPool_T& parentPool, UpdatePool_T& updatePool, 
+		std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) {
+		using namespace Gawr::ECS;
+
+		std::pmr::vector<Entity> roots(scratch);
+		for (Entity e : updatePool)
+		{
+			bool covered = false;
+			for (Entity ancestor = e; !covered && parentPool.contains(ancestor);)
+			{
+				ancestor = parentPool.getComponent(ancestor);
+				covered = updatePool.contains(ancestor);
+			}
+
+			if (!covered)
+				roots.push_back(e);
+		}
+		return roots;
+	}
+
+	// true if every parent entry is linked into its parent's child list, O(n). the lists break when Parent is emplaced or
+	// removed directly, or an entity is destroyed without destroySubtree.
+	template<typename ParentPool_T, typename ChildrenPool_T>
+	bool linked(ParentPool_T& parentPool, ChildrenPool_T& childrenPool) {
+		using namespace Gawr::ECS;
+
+		size_t count = 0;
+		for (size_t i = 0; i < childrenPool.size(); i++)
+		{
+			const Children& children = childrenPool.getComponent(childrenPool.at(i));
+			if (children.m_count == 0 || !parentPool.contains(children.m_first))
+				return false;
+
+			count += children.m_count;
+		}
+
+		if (count != parentPool.size())
+			return false;
+
+		for (size_t i = 0; i < parentPool.size(); i++)
+		{
+			Entity e = parentPool.at(i);
+			const Parent& node = parentPool.getComponent(e);
+
+			if (node.m_prev == tombstone)
+			{
+				if (!childrenPool.contains(node.m_parent) || childrenPool.getComponent(node.m_parent).m_first != e)
+					return false;
+			}
+			else if (!parentPool.contains(node.m_prev))
+			{
+				return false;
+			}
+			else
+			{
+				const Parent& prev = parentPool.getComponent(node.m_prev);
+				if (prev.m_next != e || prev.m_parent != node.m_parent)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// rebuilds every child list from the parent entries
+	template<typename ParentPool_T, typename ChildrenPool_T>
+	void relink(ParentPool_T& parentPool, ChildrenPool_T& childrenPool) {
+		while (childrenPool.size() > 0)
+			childrenPool.erase(childrenPool.size() - 1);
+
+		for (size_t i = 0; i < parentPool.size(); i++)
+			link(parentPool, childrenPool, parentPool.at(i), parentPool.getComponent(parentPool.at(i)).m_parent);
+	}
+
+	// replaces the packed order of the parent pool, order must be a permutation of the pool
+	template<typename ParentPool_T>
+	void assignOrder(ParentPool_T& parentPool, std::span<const Gawr::ECS::Entity> order) {
+		using namespace Gawr::ECS;
+
+		parentPool.template reorder<const std::span<const Entity>&>(
+			+[](typename ParentPool_T::PackedIterator begin, typename ParentPool_T::PackedIterator, const std::span<const Entity>& order) { 
+				std::copy(order.begin(), order.end(), begin); 
+			}, order);
+	}
+
+	// moves the descendants of e to their new depth bucket after e was reparented
+	template<typename ParentPool_T, typename ChildrenPool_T>
+	void updateDepths(ParentPool_T& parentPool, ChildrenPool_T& childrenPool, Gawr::ECS::Entity e) {
+		eachDescendant(parentPool, childrenPool, e, [&](Gawr::ECS::Entity child) {
+			Parent& node = parentPool.getComponent(child);
+			uint32_t depth = parentPool.contains(node.m_parent) ? parentPool.getComponent(node.m_parent).m_depth + 1 : 0;
+			if (depth == node.m_depth)
+				return;
+
+			moveDepth(parentPool, child, node.m_depth, depth);
+			parentPool.getComponent(child).m_depth = depth;
+			parentPool.update(child);
+		});
+	}
+}
+
+/// @brief sets the parent of child, maintaining the child lists and keeping the parent pool ordered by depth. reparenting
+/// moves each descendant to its new depth bucket, O(subtree * depth * log n).
+template<typename Pip_T>
+void setParent(Pip_T& pipeline, Gawr::ECS::Entity child, Gawr::ECS::Entity parent) {
+	auto& parentPool = pipeline.template pool<Parent>();
+	auto& childrenPool = pipeline.template pool<Children>();
+
+	for (Gawr::ECS::Entity ancestor = parent; ; ancestor = parentPool.getComponent(ancestor))
+	{
+		if (ancestor == child)
+			throw std::runtime_error("cannot parent an entity to itself or its descendant");
+
+		if (!parentPool.contains(ancestor))
+			break;
+	}
+
+	uint32_t depth = parentPool.contains(parent) ? parentPool.getComponent(parent).m_depth + 1 : 0;
+
+	if (parentPool.contains(child))
+	{
+		Hierarchy::internal::unlink(parentPool, childrenPool, child);
+		Hierarchy::internal::moveDepth(parentPool, child, parentPool.getComponent(child).m_depth, depth);
+
+		Parent& node = parentPool.getComponent(child);
+		node.m_parent = parent;
+		node.m_depth = depth;
+		parentPool.update(child);
+	}
+	else
+	{
+		parentPool.emplace(child, parent, depth);
+		Hierarchy::internal::moveDepth(parentPool, child, -1, depth);
+	}
+
+	Hierarchy::internal::link(parentPool, childrenPool, child, parent);
+	Hierarchy::internal::updateDepths(parentPool, childrenPool, child);
+}
+
+/// @brief removes the parent of child, maintaining the child lists and keeping the parent pool ordered by depth. 
+template<typename Pip_T>
+void clearParent(Pip_T& pipeline, Gawr::ECS::Entity child) {
+	auto& parentPool = pipeline.template pool<Parent>();
+	auto& childrenPool = pipeline.template pool<Children>();
+
+	Hierarchy::internal::unlink(parentPool, childrenPool, child);
+	Hierarchy::internal::moveDepth(parentPool, child, parentPool.getComponent(child).m_depth, -1);
+	parentPool.remove(child);
+
+	Hierarchy::internal::updateDepths(parentPool, childrenPool, child);
+}
+
+namespace Hierarchy {
+	/// @brief the direct children of an entity, iterated through the sibling links in O(1) per child.
+	template<typename ParentPool_T>
+	class ChildRange {
+	public:
+		class Iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Gawr::ECS::Entity;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Gawr::ECS::Entity*;
+			using reference = Gawr::ECS::Entity;
+
+			Iterator() = default;
+			Iterator(const ParentPool_T* pool, Gawr::ECS::Entity e) : m_pool(pool), m_curr(e) { }
+
+			Gawr::ECS::Entity operator*() const { return m_curr; }
+
+			Iterator& operator++() {
+				m_curr = m_pool->getComponent(m_curr).m_next;
+				return *this;
+			}
+
+			Iterator operator++(int) {
+				Iterator temp = *this;
+				++(*this);
+				return temp;
+			}
+
+			bool operator==(const Iterator& other) const { return m_curr == other.m_curr; }
+
+		private:
+			const ParentPool_T* m_pool = nullptr;
+			Gawr::ECS::Entity m_curr = Gawr::ECS::tombstone;
+		};
+
+		ChildRange(const ParentPool_T& pool, Gawr::ECS::Entity first, uint32_t count) : m_pool(&pool), m_first(first), m_count(count) { }
+
+		Iterator begin() const { return Iterator(m_pool, m_first); }
+		Iterator end() const { return Iterator(m_pool, Gawr::ECS::tombstone); }
+		uint32_t size() const { return m_count; }
+		bool empty() const { return m_count == 0; }
+
+	private:
+		const ParentPool_T* m_pool;
+		Gawr::ECS::Entity m_first;
+		uint32_t m_count;
+	};
+}
+
+/// @brief the direct children of e, the range is invalidated by any change to the hierarchy.
+/// @param pipeline requires read access to Parent and Children
+template<typename Pip_T>
+auto children(Pip_T& pipeline, Gawr::ECS::Entity e) {
+	auto& parentPool = pipeline.template pool<const Parent>();
+	auto& childrenPool = pipeline.template pool<const Children>();
+
+	using range_t = Hierarchy::ChildRange<std::remove_cvref_t<decltype(parentPool)>>;
+	if (!childrenPool.contains(e))
+		return range_t(parentPool, Gawr::ECS::tombstone, 0);
+
+	const Children& list = childrenPool.getComponent(e);
+	return range_t(parentPool, list.m_first, list.m_count);
+}
+
+/// @brief calls func with each descendant of root, parents before children, in O(subtree). root is not visited.
+/// @param pipeline requires read access to Parent and Children
+template<typename Pip_T, typename Func_T>
+void eachDescendant(Pip_T& pipeline, Gawr::ECS::Entity root, Func_T func) {
+	Hierarchy::internal::eachDescendant(pipeline.template pool<const Parent>(), pipeline.template pool<const Children>(), root, func);
+}
+
+/// @brief destroys each root and its descendants, the parent pool stays ordered by depth. roots may overlap. small batches
+/// move each removed entry to the back of the pool in O(subtree * depth * log n), large batches compact the pool in O(n).
+void destroySubtrees(Scene& scene, std::span<const Gawr::ECS::Entity> roots) {
 	using namespace Gawr::ECS;
 
-	auto pipeline = registry.pipeline<const Entity, Parent>();
+	std::vector<Entity> subtrees;
+	{
+		auto pipeline = scene.pipeline<const Entity, Parent, Children>();
+		auto& entityPool = pipeline.pool<const Entity>();
+		auto& parentPool = pipeline.pool<Parent>();
+		auto& childrenPool = pipeline.pool<Children>();
+
+		// a root inside another root's subtree is collected with that subtree
+		std::vector<uint8_t> collected;
+		auto isCollected = [&](Entity e) { return e < collected.size() && collected[e]; };
+		auto collect = [&](Entity e) {
+			if (collected.size() <= e)
+				collected.resize(e + 1, 0);
+
+			collected[e] = 1;
+			subtrees.push_back(e);
+		};
+
+		for (Entity root : roots)
+		{
+			if (!entityPool.valid(root) || isCollected(root))
+				continue;
+
+			collect(root);
+
+			if (parentPool.contains(root))
+				Hierarchy::internal::unlink(parentPool, childrenPool, root);
+
+			Hierarchy::internal::eachDescendant(parentPool, childrenPool, root, collect);
+		}
+
+		// child lists are destroyed with the subtrees so only the depth order is maintained
+		size_t removed = std::ranges::count_if(subtrees, [&](Entity e) { return parentPool.contains(e); });
+		if (removed * 16 < parentPool.size())
+		{
+			for (Entity e : subtrees)
+			{
+				if (!parentPool.contains(e))
+					continue;
+
+				Hierarchy::internal::moveDepth(parentPool, e, parentPool.getComponent(e).m_depth, -1);
+				parentPool.remove(e);
+			}
+		}
+		else
+		{
+			// stable partition of the survivors to the front, then pop the removed entries from the back
+			std::vector<Entity> order;
+			order.reserve(parentPool.size());
+			for (size_t i = 0; i < parentPool.size(); i++)
+			{
+				if (!isCollected(parentPool.at(i)))
+					order.push_back(parentPool.at(i));
+			}
+
+			for (size_t i = 0; i < parentPool.size(); i++)
+			{
+				if (isCollected(parentPool.at(i)))
+					order.push_back(parentPool.at(i));
+			}
+
+			Hierarchy::internal::assignOrder(parentPool, order);
+			for (size_t i = 0; i < removed; i++)
+				parentPool.erase(parentPool.size() - 1);
+		}
+	}
+
+	scene.destroy(subtrees);
+}
+
+/// @brief destroys root and its descendants, the parent pool stays ordered by depth.
+void destroySubtree(Scene& scene, Gawr::ECS::Entity root) {
+	destroySubtrees(scene, std::span<const Gawr::ECS::Entity>(&root, 1));
+}
+
+/// @brief validates the hierarchy, repairs the child lists, resolves the depth of each entity and counting sorts the parent
+/// pool by depth. runs in O(n), the sort is skipped if the order was maintained by setParent and clearParent. working
+/// buffers are allocated from scratch, eg a frame arena.
+void updateHierarchy(Scene& registry, std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) {
+	using namespace Gawr::ECS;
+
+	auto pipeline = registry.pipeline<const Entity, Parent, Children>();
 
 	auto& parentPool = pipeline.pool<Parent>();
+	auto& childrenPool = pipeline.pool<Children>();
 	auto& entityPool = pipeline.pool<const Entity>();
 
-	for (auto it = parentPool.rbegin(); it != parentPool.rend();) {	// iterate over Hierarchies in reverse
-		Parent& parent = parentPool.getComponent(*it);				// parent to current entity
+	// remove invalid parents, reverse so swap and pop only moves already validated entities
+	// the whole child list of an invalid parent is removed so no sibling links need repair
+	for (size_t i = parentPool.size(); i-- > 0;)
+	{
+		Entity parent = parentPool.getComponent(parentPool.at(i));
+		if (entityPool.valid(parent))
+			continue;
+
+		if (childrenPool.contains(parent))
+			childrenPool.remove(parent);
+
+		parentPool.erase(i);
+	}
+
+	if (!Hierarchy::internal::linked(parentPool, childrenPool))
+		Hierarchy::internal::relink(parentPool, childrenPool);
+
+	constexpr uint32_t unresolved = std::numeric_limits<uint32_t>::max();
+	constexpr uint32_t resolving = unresolved - 1;
 
-		if (!entityPool.valid(parent)) {	// if parent invalid
-			parentPool.erase(*it);			// remove parent (does not capture all error case)
-			continue;						// dont iterate new component will fill space
+	std::pmr::vector<uint32_t> depths(scratch);	// by index in parent pool
+	std::pmr::vector<size_t> chain(scratch);
+	std::pmr::vector<Entity> cycles(scratch);
+
+	// resolve depths, each entity walks up to its first resolved ancestor so is visited once
+	do {
+		for (Entity e : cycles)
+		{
+			Hierarchy::internal::unlink(parentPool, childrenPool, e);
+			parentPool.remove(e);
 		}
-						
-		if (parentPool.contains(parent))					// if parent has parent
+
+		cycles.clear();
+		depths.assign(parentPool.size(), unresolved);
+
+		for (size_t i = 0; i < parentPool.size(); i++)
 		{
-			Parent& next = parentPool.getComponent(parent);	// current entity's parent's parent 
+			if (depths[i] != unresolved)
+				continue;
+
+			chain.clear();
 
-			
-			if (parentPool.index(*it) > parentPool.index(parent))	// if parent appears before next parent 
-			{							
-				parentPool.swap(*it, parent);						// swap their order to make parent appear first
-				continue;											// dont iterate ie check parent next
+			size_t curr = i;
+			uint32_t depth = 0;
+			while (true)
+			{
+				depths[curr] = resolving;
+				chain.push_back(curr);
+
+				Entity parent = parentPool.getComponent(parentPool.at(curr));
+				if (!parentPool.contains(parent))	// parent is root
+					break;
+
+				size_t next = parentPool.index(parent);
+				if (depths[next] == unresolved)
+				{
+					curr = next;
+				}
+				else if (depths[next] == resolving)	// parent is in chain, break cycle at curr
+				{
+					cycles.push_back(parentPool.at(curr));
+					break;
+				}
+				else
+				{
+					depth = depths[next] + 1;
+					break;
+				}
 			}
+
+			for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+				depths[*it] = depth++;
+		}
+	} while (!cycles.empty());
+
+	bool sorted = true;
+	uint32_t maxDepth = 0;
+	for (size_t i = 0; i < parentPool.size(); i++)
+	{
+		Parent& node = parentPool.getComponent(parentPool.at(i));
+		if (node.m_depth != depths[i])
+		{
+			node.m_depth = depths[i];
+			parentPool.update(parentPool.at(i));
 		}
 
-		it++;
+		sorted &= (i == 0 || depths[i - 1] >= depths[i]);
+		maxDepth = std::max(maxDepth, depths[i]);
 	}
+
+	if (sorted)
+		return;
+
+	// counting sort by depth, deepest first
+	std::pmr::vector<size_t> offsets(maxDepth + 2, 0, scratch);
+	for (uint32_t depth : depths)
+		offsets[maxDepth - depth + 1]++;
+
+	for (size_t d = 1; d < offsets.size(); d++)
+		offsets[d] += offsets[d - 1];
+
+	std::pmr::vector<Entity> order(parentPool.size(), scratch);
+	for (size_t i = 0; i < parentPool.size(); i++)
+		order[offsets[maxDepth - depths[i]]++] = parentPool.at(i);
+
+	Hierarchy::internal::assignOrder(parentPool, order);
+}
+
+/// @brief validates a slice of the hierarchy, to run time sliced by a Scheduler in place of a full updateHierarchy each frame
+/// when the hierarchy is changed through setParent, clearParent and destroySubtrees. each parent entry is checked in O(1):
+/// its parent is alive, has a child list and is one level shallower, and the entry is in depth order. a broken entry, eg
+/// from destroying a parent without its subtree, is repaired with updateHierarchy which completes the pass. acquires read
+/// access to Entity, Parent and Children, and write access to repair.
+/// @return true when the pass is complete
+bool validateHierarchy(Scene& registry, Gawr::ECS::Slice& slice, std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) {
+	using namespace Gawr::ECS;
+
+	bool done;
+	bool broken = false;
+	{
+		auto pipeline = registry.pipeline<const Entity, const Parent, const Children>();
+
+		auto& parentPool = pipeline.pool<const Parent>();
+		auto& childrenPool = pipeline.pool<const Children>();
+		auto& entityPool = pipeline.pool<const Entity>();
+
+		done = sliceRange(slice, parentPool.size(), [&](size_t i) {
+			const Parent& parent = parentPool.getComponent(parentPool.at(i));
+			uint32_t depth = parentPool.contains(parent) ? parentPool.getComponent(parent).m_depth + 1 : 0;
+
+			broken |= !entityPool.valid(parent) || !childrenPool.contains(parent) || parent.m_depth != depth
+				|| (i > 0 && parentPool.getComponent(parentPool.at(i - 1)).m_depth < depth);
+		});
+	}
+
+	if (!broken)
+		return done;
+
+	updateHierarchy(registry, scratch);
+	slice.m_cursor = 0;
+	return true;
 }
 
 
 // matrix technique
-void updateLocalTransform(Scene& registry) {
+/// @brief rebuilds local matrices of updated entities from their position, rotation and scale with a batched SIMD kernel.
+/// entities without any of the three keep their local matrix. working buffers are allocated from scratch.
+void updateLocalTransform(Scene& registry, std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) {
 	using namespace Gawr::ECS;
 	using namespace Transform;
 	
 	auto pipeline = registry.pipeline<Local, const UpdateTag, const Position, const Rotation, const Scale>();
 
+	auto& localPool = pipeline.pool<Local>();
 	auto& posPool = pipeline.pool<const Position>();
 	auto& rotPool = pipeline.pool<const Rotation>();
 	auto& sclPool = pipeline.pool<const Scale>();
 
-	for (auto [e, local] : pipeline.view<Select<Entity, Transform::Local>, From<Transform::UpdateTag>>())
+	std::pmr::vector<Entity> entities(scratch);
+	for (Entity e : pipeline.view<Select<Entity>, From<UpdateTag>, Where<AllOf<Local>>>())
 	{
-		if (sclPool.contains(e))
-		{
-			local = (glm::mat4)sclPool.getComponent(e);
-			if (rotPool.contains(e)) local = rotPool.getComponent(e) * local;
-			if (posPool.contains(e)) local = posPool.getComponent(e) * local;
-		}
-		else if (rotPool.contains(e))
-		{
-			local = (glm::mat4)rotPool.getComponent(e);
-			if (posPool.contains(e)) local = posPool.getComponent(e) * local;
-		}
-		else if (posPool.contains(e)) 
-		{
-			local = (glm::mat4)rotPool.getComponent(e);
-		}
+		if (posPool.contains(e) || rotPool.contains(e) || sclPool.contains(e))
+			entities.push_back(e);
 	}
+
+	// gather into structure of arrays, missing components are identity
+	Kernel::TRSBuffer trs(scratch);
+	trs.resize(entities.size());
+	for (size_t i = 0; i < entities.size(); i++)
+	{
+		Entity e = entities[i];
+		trs.set(i,
+			posPool.contains(e) ? (const glm::vec3&)posPool.getComponent(e) : glm::vec3(0.0f),
+			rotPool.contains(e) ? (const glm::quat&)rotPool.getComponent(e) : glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+			sclPool.contains(e) ? (const glm::vec3&)sclPool.getComponent(e) : glm::vec3(1.0f));
+	}
+
+	std::pmr::vector<Affine> matrices(trs.capacity(), scratch);
+	Kernel::composeTRS(trs, matrices.data(), entities.size());
+
+	for (size_t i = 0; i < entities.size(); i++)
+		localPool.getComponent(entities[i]) = matrices[i];
+
+	localPool.update(entities);
 }
 
-void updateTransform(Scene& scene) {
+/// @brief recomputes world transforms of the subtrees rooted at entities with an update tag, and tags their descendants.
+/// costs O(tagged * depth + updated subtrees) rather than O(parented entities). working buffers are allocated from scratch.
+void updateTransform(Scene& scene, std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) {
 	using namespace Gawr::ECS;
 	using namespace Transform;
 	
+	auto pipeline = scene.pipeline<World, const Local, const Parent, const Children, UpdateTag>();
+	auto& parentPool = pipeline.pool<const Parent>();
+	auto& childrenPool = pipeline.pool<const Children>();
+	auto& localPool = pipeline.pool<const Local>();
+	auto& worldPool = pipeline.pool<World>();
+	auto& updatePool = pipeline.pool<UpdateTag>();
+
+	// found before tagging so tags added below dont cover them
+	std::pmr::vector<Entity> roots = Hierarchy::internal::dirtyRoots(parentPool, updatePool, scratch);
+
+	auto update = [&](Entity e) {
+		if (!worldPool.contains(e) || !localPool.contains(e))
+			return;
+
+		// if parent has transform
+		if (parentPool.contains(e) && worldPool.contains(parentPool.getComponent(e)))
+			// update curr by parent transform
+			worldPool.getComponent(e) = worldPool.getComponent(parentPool.getComponent(e)) * localPool.getComponent(e);
+		else
+			// copy local matrix
+			worldPool.getComponent(e) = (const Affine&)localPool.getComponent(e);
+
+		worldPool.update(e);
+	};
+
+	for (Entity root : roots)
+	{
+		update(root);
+
+		Hierarchy::internal::eachDescendant(parentPool, childrenPool, root, [&](Entity e) {
+			update(e);
+
+			// add update tag to current
+			if (!updatePool.contains(e)) updatePool.emplace(e);
+		}, scratch);
+	}
+}
+
+/// @brief propagates world transforms one depth level at a time. each level is split across threads with a barrier between
+/// levels, so parent world matrices are always read from a completed level. requires the parent pool ordered by 
+/// updateHierarchy. working buffers are allocated from scratch by the calling thread only.
+void updateTransformParallel(Scene& scene, size_t threadCount = std::thread::hardware_concurrency(), 
+	std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) {
+	using namespace Gawr::ECS;
+	using namespace Transform;
+
+	constexpr size_t minBatch = 1024;	// fewer entities per thread than this is not worth the barrier
+
 	// update root transform
 	{
 		auto pipeline = scene.pipeline<World, const Local, const Parent, const UpdateTag>();
-		for (auto [world, local] : pipeline.view<Select<World, const Local>, From<UpdateTag>, Where<AllOf<Parent>>>()) 
-			// explicit Filter
-			// Update tag implies it has Local Matrix and therfore World Matrix therefore no need to add include filter
+		auto& worldPool = pipeline.pool<World>();
+		for (Entity e : pipeline.view<Select<Entity>, From<UpdateTag>, Where<AllOf<World, Local>, NoneOf<Parent>>>())
 		{
-			world = (glm::mat4)local;
+			worldPool.getComponent(e) = (const Affine&)pipeline.pool<const Local>().getComponent(e);
+			worldPool.update(e);
 		}
 	}
 
 	// update branch transform
+	auto pipeline = scene.pipeline<World, const Local, const Parent, UpdateTag>();
+	auto& parentPool = pipeline.pool<const Parent>();
+	auto& localPool = pipeline.pool<const Local>();
+	auto& worldPool = pipeline.pool<World>();
+	auto& updatePool = pipeline.pool<UpdateTag>();
+
+	size_t count = parentPool.size();
+	if (count == 0)
+		return;
+
+	// index ranges of each depth level, the pool is ordered deepest first
+	auto depthAt = [&](size_t i) { return parentPool.getComponent(parentPool.at(i)).m_depth; };
+
+	std::pmr::vector<std::pair<size_t, size_t>> levels(depthAt(0) + 1, scratch);
+	for (uint32_t depth = 0; depth < levels.size(); depth++)
 	{
-		auto pipeline = scene.pipeline<const Entity, World, const Local, const Parent, UpdateTag>();
-		auto& updatePool = pipeline.pool<UpdateTag>();
+		auto indices = std::views::iota(size_t{ 0 }, count);
+		levels[depth].first = *std::ranges::partition_point(indices, [&](size_t i) { return depthAt(i) > depth; });
+		levels[depth].second = *std::ranges::partition_point(indices, [&](size_t i) { return depthAt(i) >= depth; });
+	}
 
-		for (auto [curr, parent, local, world] : pipeline.view<Select<Entity, const Parent, const Local, World>>())
+	// written by index so threads never modify the update pool while others read it
+	std::pmr::vector<uint8_t> updated(count, 0, scratch);
+
+	auto propagate = [&](size_t i) {
+		Entity curr = parentPool.at(i);
+		Entity parent = parentPool.getComponent(curr);
+
+		bool parentUpdated = parentPool.contains(parent) ? updated[parentPool.index(parent)] : updatePool.contains(parent);
+		if (!parentUpdated && !updatePool.contains(curr))
+			return;
+
+		updated[i] = 1;
+
+		if (!worldPool.contains(curr) || !localPool.contains(curr))
+			return;
+
+		if (worldPool.contains(parent))
+			worldPool.getComponent(curr) = worldPool.getComponent(parent) * localPool.getComponent(curr);
+		else
+			worldPool.getComponent(curr) = (const Affine&)localPool.getComponent(curr);
+	};
+
+	threadCount = std::clamp<size_t>(count / minBatch, 1, std::max<size_t>(threadCount, 1));
+
+	std::barrier sync(threadCount);
+	auto work = [&](size_t thread) {
+		for (auto [begin, end] : levels)
 		{
-			// if parent updated
-			if (updatePool.contains(parent))
-			{
-				// add update tag to current
-				if (!updatePool.contains(curr)) updatePool.emplace(curr);
+			size_t size = end - begin;
+			for (size_t i = begin + size * thread / threadCount; i < begin + size * (thread + 1) / threadCount; i++)
+				propagate(i);
 
-				// update curr by parent transform
-				world = pipeline.pool<World>().getComponent(parent) * local;
-			}
-			// if current updated
-			else if (updatePool.contains(curr))
-			{
-				// if parent has transform
-				if (pipeline.pool<World>().contains(parent))
-					// update curr by parent transform
-					world = pipeline.pool<World>().getComponent(parent) * local;
-				else
-					// copy local matrix
-					world = (glm::mat4)local;
-			}
+			sync.arrive_and_wait();
 		}
+	};
+
+	{
+		std::vector<std::jthread> workers;
+		for (size_t thread = 1; thread < threadCount; thread++)
+			workers.emplace_back(work, thread);
+
+		work(0);
 	}
 
+	// add update tag to updated children, and record the world changes the threads could not
+	for (size_t i = 0; i < count; i++)
+	{
+		Entity e = parentPool.at(i);
+		if (!updated[i])
+			continue;
+
+		if (!updatePool.contains(e))
+			updatePool.emplace(e);
+
+		if (worldPool.contains(e) && localPool.contains(e))
+			worldPool.update(e);
+	}
 }
 
-/*
 // hybrid matrix quat technique
-void updateTransform2(Scene& registry) {
+/// @brief propagates world position, rotation and scale separately through the subtrees rooted at entities with an update 
+/// tag, and tags their descendants. scale and rotation are independent so run concurrently, position needs both. the world
+/// matrix is composed only for entities that have a World component and at least one of WorldPosition, WorldRotation and 
+/// WorldScale, the World of an entity with none of them is left as it is. working buffers are allocated from scratch by 
+/// the calling thread only.
+void updateTransformHybrid(Scene& scene, std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) {
 	using namespace Gawr::ECS;
 	using namespace Transform;
-	// propergate update tag
+
+	// propergate update tag, recording each root then its descendants, parents before children
+	std::pmr::vector<Entity> updated(scratch);
 	{
-		auto pipeline = registry.pipeline<UpdateTag, const Parent>();
+		auto pipeline = scene.pipeline<const Parent, const Children, UpdateTag>();
+		auto& parentPool = pipeline.pool<const Parent>();
+		auto& childrenPool = pipeline.pool<const Children>();
+		auto& updatePool = pipeline.pool<UpdateTag>();
 
-		for (auto [e, parent] : pipeline.view<Entity, const Parent>(Exclude<UpdateTag>{}))
+		for (Entity root : Hierarchy::internal::dirtyRoots(parentPool, updatePool, scratch))
 		{
-			if (pipeline.pool<UpdateTag>().contains(parent))
-				pipeline.pool<UpdateTag>().emplace(e);
+			updated.push_back(root);
+			Hierarchy::internal::eachDescendant(parentPool, childrenPool, root, [&](Entity e) {
+				updated.push_back(e);
+				if (!updatePool.contains(e)) updatePool.emplace(e);
+			}, scratch);
 		}
 	}
 
-	auto updateScale = std::thread([&]
+	// the order is shared read only between the passes below, so the worker threads never allocate
+	auto eachUpdated = [&](auto func) {
+		for (Entity e : updated)
+			func(e);
+	};
+
+	auto updateScale = std::jthread([&]
 	{
-		auto pipeline = registry.pipeline<const UpdateTag, const Parent, const Scale, WorldScale>();
+		auto pipeline = scene.pipeline<const Parent, const Scale, WorldScale>();
+		auto& parentPool = pipeline.pool<const Parent>();
+		auto& sclPool = pipeline.pool<const Scale>();
+		auto& worldPool = pipeline.pool<WorldScale>();
 
-		for (auto [local, world] : pipeline.view<
-			Select<const Scale, WorldScale>,
-			From<UpdateTag>,
-			Exclude<Parent>>())
-		{
-			world = (glm::vec3)local;
-		}
+		eachUpdated([&](Entity e) {
+			if (!worldPool.contains(e))
+				return;
 
-		for (auto [e, parent, world] : pipeline.view<
-			Select<Entity, const Parent, WorldScale>,
-			From<Parent>,
-			Include<Parent, WorldScale, UpdateTag>>())
-		{
-			if (pipeline.pool<const Scale>().contains(e))
-			{
-				if (pipeline.pool<const WorldScale>().contains(parent))
-					world = (const glm::vec3&)pipeline.pool<const WorldScale>().getComponent(parent) *
-							(const glm::vec3&)pipeline.pool<const WorldScale>().getComponent(e);
-				else
-					world = (glm::vec3)pipeline.pool<const WorldScale>().getComponent(e);
-			}
+			glm::vec3 scale = sclPool.contains(e) ? (const glm::vec3&)sclPool.getComponent(e) : glm::vec3(1.0f);
+
+			if (parentPool.contains(e) && worldPool.contains(parentPool.getComponent(e)))
+				worldPool.getComponent(e) = (const glm::vec3&)worldPool.getComponent(parentPool.getComponent(e)) * scale;
 			else
-			{
-				if (pipeline.pool<const WorldScale>().contains(parent))
-					world = pipeline.pool<const WorldScale>().getComponent(parent);
-				//else
-				//	pipeline.pool<WorldScale>().erase(e); // if current doesnt have rotation and neither does parent
-			}
-		}
+				worldPool.getComponent(e) = scale;
+
+			worldPool.update(e);
+		});
 	});
 
-	auto updateRotation = std::thread([&]
+	auto updateRotation = std::jthread([&]
 	{
-		auto pipeline = registry.pipeline<const UpdateTag, const Parent, const Rotation, WorldRotation>();
+		auto pipeline = scene.pipeline<const Parent, const Rotation, WorldRotation>();
+		auto& parentPool = pipeline.pool<const Parent>();
+		auto& rotPool = pipeline.pool<const Rotation>();
+		auto& worldPool = pipeline.pool<WorldRotation>();
 
-		for (auto [local, world] : pipeline.view<
-			Select<const Rotation, WorldRotation>,
-			From<UpdateTag>,
-			Exclude<Parent>>())
-		{
-			world = (glm::quat)local;
-		}
+		eachUpdated([&](Entity e) {
+			if (!worldPool.contains(e))
+				return;
 
-		for (auto [e, parent, local, world] : pipeline.view<
-			Select<Entity, const Parent, Rotation, WorldRotation>,
-			From<Parent>,
-			Include<UpdateTag>>())
-		{
-			if (pipeline.pool<const WorldRotation>().contains(parent))
-				world = (const glm::quat&)pipeline.pool<const WorldRotation>().getComponent(parent) * (const glm::quat&)local;
+			glm::quat rotation = rotPool.contains(e) ? (const glm::quat&)rotPool.getComponent(e) : glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+
+			if (parentPool.contains(e) && worldPool.contains(parentPool.getComponent(e)))
+				worldPool.getComponent(e) = (const glm::quat&)worldPool.getComponent(parentPool.getComponent(e)) * rotation;
 			else
-				world = (glm::quat)local;
-		}
+				worldPool.getComponent(e) = rotation;
+
+			worldPool.update(e);
+		});
 	});
 
 	updateScale.join();
 	updateRotation.join();
 
-	auto updatePosition = std::thread([&] {
-		auto pipeline = registry.pipeline<const UpdateTag, const Parent, const Rotation, WorldRotation>();
+	{
+		auto pipeline = scene.pipeline<const Parent, const Position, const WorldScale, const WorldRotation, WorldPosition>();
+		auto& parentPool = pipeline.pool<const Parent>();
+		auto& posPool = pipeline.pool<const Position>();
+		auto& sclPool = pipeline.pool<const WorldScale>();
+		auto& rotPool = pipeline.pool<const WorldRotation>();
+		auto& worldPool = pipeline.pool<WorldPosition>();
+
+		eachUpdated([&](Entity e) {
+			if (!worldPool.contains(e))
+				return;
+
+			glm::vec3 position = posPool.contains(e) ? (const glm::vec3&)posPool.getComponent(e) : glm::vec3(0.0f);
+			worldPool.update(e);
 
-		for (auto [local, world] : pipeline.view<
-		Select<const Rotation, WorldRotation>,
-			From<UpdateTag>,
-			Exclude<Parent>>())
+			if (!parentPool.contains(e) || !worldPool.contains(parentPool.getComponent(e)))
+			{
+				worldPool.getComponent(e) = WorldPosition(position);
+				return;
+			}
+
+			Entity parent = parentPool.getComponent(e);
+			worldPool.getComponent(e) = WorldPosition(worldPool.getComponent(parent), position,
+				sclPool.contains(parent) ? (const glm::vec3&)sclPool.getComponent(parent) : glm::vec3(1.0f),
+				rotPool.contains(parent) ? (const glm::quat&)rotPool.getComponent(parent) : glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		});
+	}
+
+	// convert to matrix only where a consumer needs one
+	{
+		auto pipeline = scene.pipeline<World, const UpdateTag, const WorldPosition, const WorldRotation, const WorldScale>();
+		auto& posPool = pipeline.pool<const WorldPosition>();
+		auto& rotPool = pipeline.pool<const WorldRotation>();
+		auto& sclPool = pipeline.pool<const WorldScale>();
+		auto& worldPool = pipeline.pool<World>();
+
+		// an entity with none of the world components is not on the hybrid path, composing defaults would erase its World
+		std::pmr::vector<Entity> entities(scratch);
+		for (Entity e : pipeline.view<Select<Entity>, From<UpdateTag>, Where<AllOf<World>>>())
 		{
-			world = (glm::quat)local;
+			if (posPool.contains(e) || rotPool.contains(e) || sclPool.contains(e))
+				entities.push_back(e);
 		}
-	});
 
+		Kernel::TRSBuffer trs(scratch);
+		trs.resize(entities.size());
+		for (size_t i = 0; i < entities.size(); i++)
+		{
+			Entity e = entities[i];
+			trs.set(i,
+				posPool.contains(e) ? (const glm::vec3&)posPool.getComponent(e) : glm::vec3(0.0f),
+				rotPool.contains(e) ? (const glm::quat&)rotPool.getComponent(e) : glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+				sclPool.contains(e) ? (const glm::vec3&)sclPool.getComponent(e) : glm::vec3(1.0f));
+		}
+
+		std::pmr::vector<Affine> matrices(trs.capacity(), scratch);
+		Kernel::composeTRS(trs, matrices.data(), entities.size());
+
+		for (size_t i = 0; i < entities.size(); i++)
+			worldPool.getComponent(entities[i]) = matrices[i];
 
-	updatePosition.join();
+		worldPool.update(entities);
+	}
 }
 
-*/
+enum class TransformMode { 
+	Matrix,			// world = parent world * local, walks dirty subtrees
+	MatrixParallel,	// world = parent world * local, every parented entity one depth level at a time across threads
+	Hybrid			// world position, rotation and scale propagated separately, matrix composed only where needed
+};
+
+/// @brief updates world transforms of entities with an update tag and their descendants using the selected technique.
+/// working buffers are allocated from scratch, eg the frame allocator's resource for the calling thread.
+void updateWorldTransform(Scene& scene, TransformMode mode = TransformMode::Matrix, std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) {
+	switch (mode)
+	{
+	case TransformMode::Matrix:			updateTransform(scene, scratch);												break;
+	case TransformMode::MatrixParallel:	updateTransformParallel(scene, std::thread::hardware_concurrency(), scratch);	break;
+	case TransformMode::Hybrid:			updateTransformHybrid(scene, scratch);											break;
+	}
+}
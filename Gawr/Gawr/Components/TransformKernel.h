@@ -0,0 +1,172 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "Affine.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// GAWR_X86 and the intrinsics header come from Affine.h
+#if defined(GAWR_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GAWR_TARGET_AVX
+#else
+#define GAWR_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+// composes affine matrices directly from position, rotation and scale. a full translate * rotate * scale matrix multiply is
+// 128 multiply adds mostly against known zeros, composing directly is 9 for the scaled rotation columns. entities are
+// processed in structure of arrays batches of 4 (SSE) or 8 (AVX), the path is selected once by cpu feature.
+namespace Transform::Kernel {
+	/// @brief structure of arrays input, padded to a multiple of 8 with identity transforms.
+	struct TRSBuffer {
+		std::pmr::vector<float> px, py, pz;		// position
+		std::pmr::vector<float> qx, qy, qz, qw;	// rotation
+		std::pmr::vector<float> sx, sy, sz;		// scale
+
+		explicit TRSBuffer(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			: px(resource), py(resource), pz(resource), qx(resource), qy(resource), qz(resource), qw(resource), sx(resource), sy(resource), sz(resource)
+		{ }
+
+		void resize(size_t count) {
+			size_t padded = (count + 7) & ~size_t{ 7 };
+			for (auto* lane : { &px, &py, &pz, &qx, &qy, &qz }) lane->assign(padded, 0.0f);
+			for (auto* lane : { &qw, &sx, &sy, &sz }) lane->assign(padded, 1.0f);
+		}
+
+		size_t capacity() const { return px.size(); }
+
+		void set(size_t i, const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scl) {
+			px[i] = pos.x; py[i] = pos.y; pz[i] = pos.z;
+			qx[i] = rot.x; qy[i] = rot.y; qz[i] = rot.z; qw[i] = rot.w;
+			sx[i] = scl.x; sy[i] = scl.y; sz[i] = scl.z;
+		}
+	};
+
+	namespace internal {
+		inline void composeScalar(const TRSBuffer& in, Affine* out, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				float x = in.qx[i], y = in.qy[i], z = in.qz[i], w = in.qw[i];
+				float xx = x * x, yy = y * y, zz = z * z;
+				float xy = x * y, xz = x * z, yz = y * z;
+				float wx = w * x, wy = w * y, wz = w * z;
+				float sx = in.sx[i], sy = in.sy[i], sz = in.sz[i];
+
+				glm::vec4* rows = out[i].m_rows;
+				rows[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * sx, 2.0f * (xy - wz) * sy, 2.0f * (xz + wy) * sz, in.px[i]);
+				rows[1] = glm::vec4(2.0f * (xy + wz) * sx, (1.0f - 2.0f * (xx + zz)) * sy, 2.0f * (yz - wx) * sz, in.py[i]);
+				rows[2] = glm::vec4(2.0f * (xz - wy) * sx, 2.0f * (yz + wx) * sy, (1.0f - 2.0f * (xx + yy)) * sz, in.pz[i]);
+			}
+		}
+
+#if defined(GAWR_X86)
+		// transposes 4 lanes of 4 components into a row for each of 4 matrices
+		inline void storeRows(__m128 x, __m128 y, __m128 z, __m128 w, Affine* out, int row) {
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			_mm_store_ps(&out[0].m_rows[row][0], x);
+			_mm_store_ps(&out[1].m_rows[row][0], y);
+			_mm_store_ps(&out[2].m_rows[row][0], z);
+			_mm_store_ps(&out[3].m_rows[row][0], w);
+		}
+
+		inline void composeSSE(const TRSBuffer& in, Affine* out, size_t begin, size_t end) {
+			const __m128 two = _mm_set1_ps(2.0f), half = _mm_set1_ps(0.5f);
+
+			for (size_t i = begin; i < end; i += 4)
+			{
+				__m128 x = _mm_loadu_ps(&in.qx[i]), y = _mm_loadu_ps(&in.qy[i]), z = _mm_loadu_ps(&in.qz[i]), w = _mm_loadu_ps(&in.qw[i]);
+				__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+				__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+				__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+				__m128 sx = _mm_mul_ps(two, _mm_loadu_ps(&in.sx[i]));
+				__m128 sy = _mm_mul_ps(two, _mm_loadu_ps(&in.sy[i]));
+				__m128 sz = _mm_mul_ps(two, _mm_loadu_ps(&in.sz[i]));
+
+				// 1 - 2a = (0.5 - a) * 2, scale folded into the factor of 2
+				storeRows(
+					_mm_mul_ps(_mm_sub_ps(half, _mm_add_ps(yy, zz)), sx),
+					_mm_mul_ps(_mm_sub_ps(xy, wz), sy),
+					_mm_mul_ps(_mm_add_ps(xz, wy), sz),
+					_mm_loadu_ps(&in.px[i]), out + i, 0);
+				storeRows(
+					_mm_mul_ps(_mm_add_ps(xy, wz), sx),
+					_mm_mul_ps(_mm_sub_ps(half, _mm_add_ps(xx, zz)), sy),
+					_mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+					_mm_loadu_ps(&in.py[i]), out + i, 1);
+				storeRows(
+					_mm_mul_ps(_mm_sub_ps(xz, wy), sx),
+					_mm_mul_ps(_mm_add_ps(yz, wx), sy),
+					_mm_mul_ps(_mm_sub_ps(half, _mm_add_ps(xx, yy)), sz),
+					_mm_loadu_ps(&in.pz[i]), out + i, 2);
+			}
+		}
+
+		GAWR_TARGET_AVX inline void storeRows(__m256 x, __m256 y, __m256 z, __m256 w, Affine* out, int row) {
+			storeRows(_mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), _mm256_castps256_ps128(w), out, row);
+			storeRows(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), _mm256_extractf128_ps(w, 1), out + 4, row);
+		}
+
+		GAWR_TARGET_AVX inline void composeAVX(const TRSBuffer& in, Affine* out, size_t begin, size_t end) {
+			const __m256 two = _mm256_set1_ps(2.0f), half = _mm256_set1_ps(0.5f);
+
+			for (size_t i = begin; i < end; i += 8)
+			{
+				__m256 x = _mm256_loadu_ps(&in.qx[i]), y = _mm256_loadu_ps(&in.qy[i]), z = _mm256_loadu_ps(&in.qz[i]), w = _mm256_loadu_ps(&in.qw[i]);
+				__m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+				__m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+				__m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+				__m256 sx = _mm256_mul_ps(two, _mm256_loadu_ps(&in.sx[i]));
+				__m256 sy = _mm256_mul_ps(two, _mm256_loadu_ps(&in.sy[i]));
+				__m256 sz = _mm256_mul_ps(two, _mm256_loadu_ps(&in.sz[i]));
+
+				storeRows(
+					_mm256_mul_ps(_mm256_sub_ps(half, _mm256_add_ps(yy, zz)), sx),
+					_mm256_mul_ps(_mm256_sub_ps(xy, wz), sy),
+					_mm256_mul_ps(_mm256_add_ps(xz, wy), sz),
+					_mm256_loadu_ps(&in.px[i]), out + i, 0);
+				storeRows(
+					_mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+					_mm256_mul_ps(_mm256_sub_ps(half, _mm256_add_ps(xx, zz)), sy),
+					_mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+					_mm256_loadu_ps(&in.py[i]), out + i, 1);
+				storeRows(
+					_mm256_mul_ps(_mm256_sub_ps(xz, wy), sx),
+					_mm256_mul_ps(_mm256_add_ps(yz, wx), sy),
+					_mm256_mul_ps(_mm256_sub_ps(half, _mm256_add_ps(xx, yy)), sz),
+					_mm256_loadu_ps(&in.pz[i]), out + i, 2);
+			}
+		}
+
+		inline bool supportsAVX() {
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			bool osxsave = info[2] & (1 << 27), avx = info[2] & (1 << 28);
+			return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;	// os saves xmm and ymm state
+#else
+			return __builtin_cpu_supports("avx");
+#endif
+		}
+#endif
+	}
+
+	/// @brief writes out[i] = translate(p[i]) * mat4_cast(q[i]) * scale(s[i]) for i in [0, count).
+	/// @param out must have room for in.capacity() matrices as the padded tail is also written
+	inline void composeTRS(const TRSBuffer& in, Affine* out, size_t count) {
+		using compose_func_t = void(*)(const TRSBuffer&, Affine*, size_t, size_t);
+
+#if defined(GAWR_X86)
+		static const compose_func_t compose = internal::supportsAVX() ? internal::composeAVX : internal::composeSSE;
+#else
+		static const compose_func_t compose = internal::composeScalar;
+#endif
+		compose(in, out, 0, std::min(in.capacity(), (count + 7) & ~size_t{ 7 }));
+	}
+}
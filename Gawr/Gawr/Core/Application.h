@@ -32,6 +32,10 @@
 //				 -> reduces 'pipeline.pool<A>().emplace()' to 'pipeline.emplace<A>()'
 //				 -> how would it handle the const vs non const?
 //				 -> could do a simple requirement disabling as necessary
+//
+//		chosen   -> pools record events into a buffer per event type while write locked (see ECS/Signal.h)
+//				 -> the pipeline takes the buffers before unlocking and dispatches them once access is released
+//				 -> listeners are called once per batch so may acquire their own pipelines without deadlocking
 
 
 
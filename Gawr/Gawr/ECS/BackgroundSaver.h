@@ -0,0 +1,146 @@
+#pragma once
+#include "Registry.h"
+#include "Delta.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Gawr::ECS {
+	/// @brief saves point in time snapshots of a registry on a background thread, without holding its pools for the length
+	/// of the save. the saver keeps a mirror of the registry and versions it with deltas. a save only takes the delta of
+	/// changes since the previous save, under read access to the live pools, in O(churn). the saver's thread applies the
+	/// delta to the mirror and writes the mirror to file while systems keep writing to the live registry. components
+	/// modified in place must be marked with update(e) to be saved, see DeltaRecorder.
+	template<typename ... Ts>
+	class BackgroundSaver {
+		struct Request {
+			std::vector<std::byte>	m_delta;
+			std::filesystem::path	m_path;	// empty to only apply the delta
+		};
+
+	public:
+		/// @brief seeds the mirror with every entity of reg, the registry is read once in O(entities) and the mirror is
+		/// built on the saver's thread. the saver must not outlive reg.
+		/// @param resource backs the mirror registry
+		explicit BackgroundSaver(Registry<Ts...>& reg, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			: m_mirror(resource), m_recorder(reg)
+		{
+			Request request;
+			m_recorder.takeAll(request.m_delta);
+			m_pending.push_back(std::move(request));
+			m_requested = 1;
+
+			m_thread = std::jthread([this](std::stop_token stop) { run(stop); });
+		}
+
+		/// @brief finishes every save already requested.
+		~BackgroundSaver() {
+			m_thread.request_stop();
+			m_thread.join();
+		}
+
+		BackgroundSaver(const BackgroundSaver&) = delete;
+		BackgroundSaver& operator=(const BackgroundSaver&) = delete;
+
+		/// @brief captures the current state of the registry and writes it to a snapshot file at path in the background,
+		/// readable with Registry::load. the state captured is consistent while other threads write, see DeltaRecorder::take.
+		/// must be called from a single thread and not from a listener. acquires read access to every pool of the registry
+		/// while the delta is taken.
+		void save(const std::filesystem::path& path) {
+			Request request{ .m_delta = buffer(), .m_path = path };
+			m_recorder.take(request.m_delta);
+
+			{
+				std::lock_guard guard(m_mtx);
+				m_pending.push_back(std::move(request));
+				m_requested++;
+			}
+			m_wake.notify_one();
+		}
+
+		/// @brief true while a save is being written.
+		bool busy() const {
+			std::lock_guard guard(m_mtx);
+			return m_completed != m_requested;
+		}
+
+		/// @brief blocks until every save requested has been written, rethrows the first error of a save since the last wait.
+		void wait() {
+			std::unique_lock lock(m_mtx);
+			m_idle.wait(lock, [&]() { return m_completed == m_requested; });
+
+			if (m_error)
+				std::rethrow_exception(std::exchange(m_error, nullptr));
+		}
+
+	private:
+		// reuses the delta buffers of completed requests so a steady autosave does not allocate on the calling thread
+		std::vector<std::byte> buffer() {
+			std::lock_guard guard(m_mtx);
+			if (m_buffers.empty())
+				return { };
+
+			std::vector<std::byte> bytes = std::move(m_buffers.back());
+			m_buffers.pop_back();
+			return bytes;
+		}
+
+		// deltas are applied in order, so pending requests are completed before stopping
+		void run(std::stop_token stop) {
+			while (true)
+			{
+				Request request;
+				{
+					std::unique_lock lock(m_mtx);
+					if (!m_wake.wait(lock, stop, [&]() { return !m_pending.empty(); }))
+						return;
+
+					request = std::move(m_pending.front());
+					m_pending.pop_front();
+				}
+
+				std::exception_ptr error;
+				try
+				{
+					m_mirror.applyDelta(request.m_delta);
+					if (!request.m_path.empty())
+						m_mirror.save(request.m_path);
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+				}
+
+				{
+					std::lock_guard guard(m_mtx);
+					if (error && !m_error)
+						m_error = error;
+
+					m_buffers.push_back(std::move(request.m_delta));
+					m_completed++;
+				}
+				m_idle.notify_all();
+			}
+		}
+
+		Registry<Ts...>						m_mirror;
+		DeltaRecorder<Ts...>				m_recorder;
+
+		mutable std::mutex					m_mtx;
+		std::condition_variable_any			m_wake;
+		std::condition_variable				m_idle;
+		std::deque<Request>					m_pending;
+		std::vector<std::vector<std::byte>>	m_buffers;
+		std::exception_ptr					m_error;
+		size_t								m_requested = 0;
+		size_t								m_completed = 0;
+
+		std::jthread						m_thread;	// last, joined before the members it uses are destroyed
+	};
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "Entity.h"
+#include "Filters.h"
+#include "Signal.h"
+
+#include <initializer_list>
+#include <mutex>
+#include <vector>
+
+namespace Gawr::ECS {
+	template<typename Where_T>
+	class Collector;
+
+	/// @brief a deduplicated set of entities that gained, lost or modified a component named by the filter since it was last
+	/// drained. entities are collected from pool signals so the set may include entities that no longer match, use
+	/// Where_T::match to separate entities that gained or modified from those that lost. the collector must not outlive the
+	/// registry it was connected to.
+	/// @tparam Where_T the filter, changes to AllOf components are collected on construct, update and destroy, changes to
+	/// NoneOf components are collected on construct and destroy
+	template<typename ... AllOf_Ts, typename ... NoneOf_Ts>
+	class Collector<Where<AllOf<AllOf_Ts...>, NoneOf<NoneOf_Ts...>>> {
+	public:
+		using Where_T = Where<AllOf<AllOf_Ts...>, NoneOf<NoneOf_Ts...>>;
+
+		/// @param pipeline any pipeline with access to the filtered pools, read access is sufficient
+		template<typename Pip_T>
+		Collector(Pip_T& pipeline) {
+			(connect<AllOf_Ts>(pipeline, { Event::Construct, Event::Update, Event::Destroy }), ...);
+			(connect<NoneOf_Ts>(pipeline, { Event::Construct, Event::Destroy }), ...);
+		}
+
+		~Collector() {
+			for (auto [signal, handle] : m_connections)
+				signal->disconnect(handle);
+		}
+
+		Collector(const Collector&) = delete;
+		Collector& operator=(const Collector&) = delete;
+
+		size_t size() const {
+			std::lock_guard guard(m_mtx);
+			return m_packed.size();
+		}
+
+		bool contains(Entity e) const {
+			std::lock_guard guard(m_mtx);
+			return e < m_sparse.size() && m_sparse[e] != tombstone;
+		}
+
+		/// @brief moves the collected entities into out and clears the collector in O(collected).
+		/// @param out reused between frames to avoid reallocating, its previous contents are discarded
+		void drain(std::vector<Entity>& out) {
+			out.clear();
+
+			std::lock_guard guard(m_mtx);
+			std::swap(out, m_packed);
+			for (Entity e : out)
+				m_sparse[e] = tombstone;
+		}
+
+		std::vector<Entity> drain() {
+			std::vector<Entity> out;
+			drain(out);
+			return out;
+		}
+
+	private:
+		template<typename U, typename Pip_T>
+		void connect(Pip_T& pipeline, std::initializer_list<Event> events) {
+			auto& pool = pipeline.template pool<const U>();
+
+			for (Event event : events)
+			{
+				const Signal& signal = pool.on(event);
+				m_connections.emplace_back(&signal, signal.connect([this](std::span<const Entity> entities) { insert(entities); }));
+			}
+		}
+
+		void insert(std::span<const Entity> entities) {
+			std::lock_guard guard(m_mtx);
+			for (Entity e : entities)
+			{
+				if (m_sparse.size() <= e)
+					m_sparse.resize(e + 1, tombstone);
+
+				if (m_sparse[e] != tombstone)
+					continue;
+
+				m_sparse[e] = m_packed.size();
+				m_packed.push_back(e);
+			}
+		}
+
+		std::vector<std::pair<const Signal*, size_t>> m_connections;
+		mutable std::mutex	m_mtx;
+		std::vector<size_t>	m_sparse;
+		std::vector<Entity>	m_packed;
+	};
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "Registry.h"
+#include "Collector.h"
+#include "Snapshot.h"
+
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+namespace Gawr::ECS {
+	/// @brief records which entities changed in each pool of a registry and encodes them as a delta, the entities created,
+	/// destroyed or modified since the previous delta, or since the recorder was constructed for the first. a delta holds
+	/// only the changed entries of each pool so its size and the time to take it are proportional to churn. deltas are
+	/// applied in order with Registry::applyDelta onto a registry in the state of the baseline, eg one loaded from a
+	/// snapshot saved when the recorder was constructed.
+	/// components modified in place must be marked with update(e) to be recorded, as the hierarchy and transform systems do
+	/// for every component they write. compact, shrink and load are not recorded, construct a new recorder and baseline
+	/// after them. the recorder must not outlive the registry.
+	template<typename ... Ts>
+	class DeltaRecorder {
+	public:
+		explicit DeltaRecorder(Registry<Ts...>& reg) : DeltaRecorder(reg, reg.template pipeline<const Ts...>()) { }
+
+		DeltaRecorder(const DeltaRecorder&) = delete;
+		DeltaRecorder& operator=(const DeltaRecorder&) = delete;
+
+		/// @brief replaces out with a delta of the changes since the last take and starts the next delta from the current
+		/// state. the delta is a consistent cut, every write pipeline released before it has dispatched its events to the
+		/// recorder, so waits for a dispatch in flight on another thread. acquires read access to every pool, must not be 
+		/// called from a listener.
+		/// @param out reused between deltas to avoid reallocating, its previous contents are discarded
+		void take(std::vector<std::byte>& out) {
+			out.clear();
+			ByteWriter writer(out);
+
+			writer.write(uint64_t{ sizeof...(Ts) });
+			(writer.write(internal::typeHash<Ts>()), ...);
+
+			settled([&](auto& pip)
+			{
+				([&]<typename U>()
+				{
+					std::get<Collector<Where<AllOf<U>>>>(m_collectors).drain(m_changed);
+					pip.template pool<const U>().saveDelta(writer, m_changed);
+				}.template operator()<Ts>(), ...);
+			});
+		}
+
+		std::vector<std::byte> take() {
+			std::vector<std::byte> out;
+			take(out);
+			return out;
+		}
+
+		/// @brief replaces out with a delta holding every entity of every pool, which applied to an empty registry 
+		/// reproduces the current state, and starts the next delta from the current state. O(entities), eg to seed a copy
+		/// of the registry kept up to date with later deltas. waits for a dispatch in flight as take does. acquires read 
+		/// access to every pool, must not be called from a listener.
+		void takeAll(std::vector<std::byte>& out) {
+			out.clear();
+			ByteWriter writer(out);
+
+			writer.write(uint64_t{ sizeof...(Ts) });
+			(writer.write(internal::typeHash<Ts>()), ...);
+
+			std::vector<Entity>& changed = m_changed;
+			settled([&](auto& pip)
+			{
+				([&]<typename U>()
+				{
+					auto& pool = pip.template pool<const U>();
+					std::get<Collector<Where<AllOf<U>>>>(m_collectors).drain(changed);
+
+					// handles are written for every node including the free ones, other pools for the entities they contain
+					if constexpr (std::is_same_v<U, Entity>)
+					{
+						size_t count = pool.stats().m_sparse;
+						changed.resize(count);
+						std::iota(changed.begin(), changed.end(), Entity{ 0 });
+					}
+					else
+					{
+						changed.assign(pool.rbegin(), pool.rend());
+					}
+
+					pool.saveDelta(writer, changed);
+				}.template operator()<Ts>(), ...);
+			});
+		}
+
+	private:
+		// calls func with read access to every pool once the collectors hold every change made to them. a writer releases
+		// its pools before dispatching, so a delta cut in between would write data the collectors have not been told of
+		// and miss the rest of that writer's changes. if a writer released its pools between the wait and the acquire 
+		// they are released and the wait repeated.
+		template<typename Func_T>
+		void settled(Func_T func) {
+			while (true)
+			{
+				m_reg.waitForDispatch();
+
+				auto pip = m_reg.template pipeline<const Ts...>();
+				if (m_reg.dispatching())
+					continue;
+
+				func(pip);
+				return;
+			}
+		}
+
+		template<typename Pip_T>
+		DeltaRecorder(Registry<Ts...>& reg, Pip_T&& pipeline)
+			: m_reg(reg), m_collectors(((void)sizeof(Ts), pipeline)...)
+		{ }
+
+		Registry<Ts...>&								m_reg;
+		std::tuple<Collector<Where<AllOf<Ts>>>...>	m_collectors;
+		std::vector<Entity>								m_changed;	// scratch for the pool being written
+	};
+}
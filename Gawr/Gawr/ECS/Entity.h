@@ -1,8 +1,20 @@
 #pragma once
 #include <stdint.h>
+#include <limits>
+#include <vector>
 
 namespace Gawr::ECS {
 	/// @brief an uint ID to represent a collection of unique components
 	using Entity = uint32_t;
 	constexpr Entity tombstone = std::numeric_limits<Entity>::max();
-}
\ No newline at end of file
+
+	/// @brief maps entities from before a registry compaction to after, entities that were not alive map to tombstone. 
+	/// components holding entities can define void remap(const EntityRemap&) to be remapped by the compaction.
+	struct EntityRemap {
+		std::vector<Entity> m_table;	// by old entity
+
+		Entity operator()(Entity e) const {
+			return e < m_table.size() ? m_table[e] : tombstone;
+		}
+	};
+}
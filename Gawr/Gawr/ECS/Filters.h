@@ -1,4 +1,6 @@
 #pragma once
+#include <span>
+
 namespace Gawr::ECS {
 	namespace internal {
 		template<typename T, typename ... Ts>
@@ -24,7 +26,7 @@ namespace Gawr::ECS {
 				if constexpr (std::is_same_v<T0, Entity>)
 					return e;
 				else
-					return pipeline.pool<T0>().getComponent(e);
+					return pipeline.template pool<T0>().getComponent(e);
 			}
 			else 
 			{
@@ -33,8 +35,8 @@ namespace Gawr::ECS {
 					if constexpr (std::is_same_v<U, Entity>)
 						return std::tuple(e);
 					else
-						return std::tuple<U&>{ pipeline.pool<U>().getComponent(e) };
-				}.operator()<Ts>()...);
+						return std::tuple<U&>{ pipeline.template pool<U>().getComponent(e) };
+				}.template operator()<Ts>()...);
 			}
 		}
 	};
@@ -44,12 +46,18 @@ namespace Gawr::ECS {
 		using type = const T;
 	};
 
+	/// @brief drives a view from a range of entities rather than a pool, eg the result of an index lookup. the range must 
+	/// outlive the view.
+	struct FromEntities {
+		std::span<const Entity> m_entities;
+	};
+
 	template<typename ... Ts>
 	struct AllOf {
 		template<typename Pip_T>
 		static bool match(Pip_T& pip, Entity e) {
 			if constexpr (sizeof...(Ts) == 0) return true;
-			return (pip.pool<const Ts>().contains(e) && ...);
+			return (pip.template pool<const Ts>().contains(e) && ...);
 		}
 	};
 
@@ -58,7 +66,7 @@ namespace Gawr::ECS {
 		template<typename Pip_T>
 		static bool match(Pip_T& pip, Entity e) {
 			if constexpr (sizeof...(Ts) == 0) return true;
-			return !(pip.pool<const Ts>().contains(e) || ...);
+			return !(pip.template pool<const Ts>().contains(e) || ...);
 		}
 	};
 
@@ -67,7 +75,7 @@ namespace Gawr::ECS {
 
 	template<typename ... AllOfArgs, typename ... NoneOfArgs>
 	struct Where<AllOf<AllOfArgs...>, NoneOf<NoneOfArgs...>> {
-		static_assert((!Contains<NoneOfArgs, AllOfArgs...>::value && ...), "NoneOf Filter intersects with AllOf Filter");
+		static_assert((!internal::Contains<NoneOfArgs, AllOfArgs...>::value && ...), "NoneOf Filter intersects with AllOf Filter");
 		template<typename Pip_T>
 		static bool match(Pip_T& pip, Entity e) {
 			return AllOf<AllOfArgs...>::match(pip, e) && NoneOf<NoneOfArgs...>::match(pip, e);
@@ -1,17 +1,32 @@
 #pragma once
+#include "Entity.h"
 #include "AccessLock.h"
+#include "Signal.h"
+#include "PoolStats.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <memory_resource>
 #include <set>
 
 namespace Gawr::ECS {
+	/// @brief entity handles in a free list. records construct on create, destroy on erase and update for entities whose 
+	/// links in the handle lists changed, eg the neighbours of an erased entity.
 	class HandleManager : public AccessLock {
 	private:
 		struct node { std::ptrdiff_t prev, next; };
 	
 	public:
+		/// @param resource allocates the node array, must outlive the pool
+		explicit HandleManager(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			: m_nodes(resource)
+		{ }
+
 		struct Iterator {
 		public:
 			Iterator(const HandleManager& m, Entity e)
-				: m_node(&m.m_nodes[0] + e), m_curr(e) 
+				: m_node(e < m.m_nodes.size() ? m.m_nodes.data() + e : nullptr), m_curr(e) 
 			{ }
 
 			Entity operator*() {
@@ -67,6 +82,8 @@ namespace Gawr::ECS {
 				node* begin = &m_nodes[m_begin];
 				begin->prev = curr - begin;		// offset from prev to curr
 				curr->next = begin - curr;		// offset from curr to prev
+				curr->prev = 0;					// clears the invalid mark of a reused node
+				signal(Event::Update).record(m_begin);
 			}
 			else
 			{
@@ -75,6 +92,7 @@ namespace Gawr::ECS {
 			}
 
 			m_begin = curr - &m_nodes[0];	// set begin to curr
+			signal(Event::Construct).record(e);
 			return e;
 		}
 
@@ -95,11 +113,13 @@ namespace Gawr::ECS {
 				next = curr + curr->next;
 				m_begin = next - &m_nodes[0];
 				next->prev = 0;
+				signal(Event::Update).record(m_begin);
 				break;
 
 			case 2: // [..., prev, X]
 				prev = curr + curr->prev;
 				prev->next = 0;
+				signal(Event::Update).record(static_cast<Entity>(prev - &m_nodes[0]));
 				break;
 
 			case 3: // [..., prev, X, next, ...]
@@ -108,6 +128,8 @@ namespace Gawr::ECS {
 
 				next->prev = prev - next;	// offset from next to prev
 				prev->next = next - prev;	// offset from prev to next
+				signal(Event::Update).record(static_cast<Entity>(prev - &m_nodes[0]));
+				signal(Event::Update).record(static_cast<Entity>(next - &m_nodes[0]));
 				break;
 			}
 			
@@ -118,6 +140,7 @@ namespace Gawr::ECS {
 
 			curr->prev = std::numeric_limits<std::ptrdiff_t>::max();	// mark as invalid
 			m_end = e;													// set as beginning of invalid list
+			signal(Event::Destroy).record(e);
 		}
 
 		void update(Entity e) {
@@ -129,21 +152,22 @@ namespace Gawr::ECS {
 			node* prev = curr + curr->prev;
 			
 			if (curr->next == 0) {
-				prev = curr + curr->prev;
 				prev->next = 0;
 			}
 			else {
-				next = curr + curr->next;
-				prev = curr + curr->prev;
-
 				next->prev = prev - next;	// offset from next to prev
 				prev->next = next - prev;	// offset from prev to next
+				signal(Event::Update).record(static_cast<Entity>(next - &m_nodes[0]));
 			}
+			signal(Event::Update).record(static_cast<Entity>(prev - &m_nodes[0]));
 
 			node* begin = &m_nodes[m_begin];
-			next->prev = curr - begin;		// offset from begin to curr
+			begin->prev = curr - begin;		// offset from begin to curr
 			curr->next = begin - curr;		// offset from curr to begin
+			curr->prev = 0;
 
+			signal(Event::Update).record(m_begin);
+			signal(Event::Update).record(e);
 			m_begin = e;
 		}
 		
@@ -159,9 +183,203 @@ namespace Gawr::ECS {
 			return Iterator(*this, std::numeric_limits<uint32_t>::max());
 		}
 
+		/// @brief renumbers the valid entities into [0, count) keeping their relative order and releases the invalid ones, 
+		/// the node array shrinks to count. iteration order is unchanged.
+		EntityRemap compact() {
+			EntityRemap remap{ std::vector<Entity>(m_nodes.size(), tombstone) };
+
+			Entity count = 0;
+			for (Entity e = 0; e < m_nodes.size(); e++)
+			{
+				if (valid(e))
+					remap.m_table[e] = count++;
+			}
+
+			std::vector<Entity> order;
+			order.reserve(count);
+			for (Iterator it = begin(); it != end(); ++it)
+				order.push_back(remap(*it));
+
+			m_nodes.assign(count, node{});
+			for (size_t i = 0; i < order.size(); i++)
+			{
+				node& curr = m_nodes[order[i]];
+				curr.prev = i == 0 ? 0 : std::ptrdiff_t(order[i - 1]) - std::ptrdiff_t(order[i]);
+				curr.next = i + 1 == order.size() ? 0 : std::ptrdiff_t(order[i + 1]) - std::ptrdiff_t(order[i]);
+			}
+
+			m_begin = order.empty() ? std::numeric_limits<uint32_t>::max() : order[0];
+			m_end = std::numeric_limits<uint32_t>::max();
+			return remap;
+		}
+
+		/// @brief replaces every handle with a copy of other's, reusing the node array. records an update event for every 
+		/// node.
+		void copy(const HandleManager& other) {
+			m_nodes = other.m_nodes;
+			m_begin = other.m_begin;
+			m_end = other.m_end;
+			recordAll(Event::Update);
+		}
+
+		/// @brief memory used by the pool, every invalid node is a tombstone. O(n) in the number of nodes.
+		PoolStats stats() const {
+			PoolStats stats{ .m_sparse = m_nodes.size() };
+			for (Entity e = 0; e < m_nodes.size(); e++)
+				stats.m_tombstones += !valid(e);
+
+			stats.m_count = m_nodes.size() - stats.m_tombstones;
+			stats.m_bytesUsed = m_nodes.size() * sizeof(node);
+			stats.m_bytesReserved = m_nodes.capacity() * sizeof(node);
+			return stats;
+		}
+
+		/// @brief releases the invalid nodes after the highest valid entity and the capacity beyond the node array. ids are 
+		/// unchanged, the remaining invalid ids are reused lowest first.
+		void shrink() {
+			size_t size = m_nodes.size();
+			while (size > 0 && !valid(static_cast<Entity>(size - 1)))
+				size--;
+
+			m_nodes.resize(size);
+			m_nodes.shrink_to_fit();
+
+			// rebuild the invalid list from the remaining invalid nodes, pushed highest first so the lowest is popped first
+			m_end = std::numeric_limits<uint32_t>::max();
+			for (size_t e = size; e-- > 0;)
+			{
+				if (valid(static_cast<Entity>(e)))
+					continue;
+
+				node* curr = &m_nodes[e];
+				curr->next = m_end != std::numeric_limits<uint32_t>::max() ? &m_nodes[m_end] - curr : 0;
+				m_end = static_cast<uint32_t>(e);
+			}
+		}
+
+		/// @brief writes the node array and both list heads to a snapshot.
+		void save(SnapshotWriter& writer) const {
+			writer.array<node>(m_nodes);
+			writer.scalar(m_begin);
+			writer.scalar(m_end);
+		}
+
+		/// @brief replaces every handle with those saved to a snapshot, the node array is one bulk copy from the mapping.
+		/// throws std::runtime_error if a list head or link is out of range, the handles are unchanged in that case. records
+		/// an update event for every node.
+		void load(SnapshotReader& reader) {
+			// read off to the side so nothing is replaced until the lists are checked
+			HandleManager staged(m_nodes.get_allocator().resource());
+			reader.read(staged.m_nodes);
+			staged.m_begin = static_cast<uint32_t>(reader.scalar());
+			staged.m_end = static_cast<uint32_t>(reader.scalar());
+
+			constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+			std::ptrdiff_t size = staged.m_nodes.size();
+			if ((staged.m_begin != none && staged.m_begin >= size) || (staged.m_end != none && staged.m_end >= size))
+				throw std::runtime_error("snapshot handle list out of range");
+
+			// links are offsets, compared without forming the sum so a corrupt offset cannot overflow
+			auto linked = [&](std::ptrdiff_t e, std::ptrdiff_t offset) { return offset >= -e && offset < size - e; };
+			for (std::ptrdiff_t e = 0; e < size; e++)
+			{
+				const node& curr = staged.m_nodes[e];
+				bool invalid = curr.prev == std::numeric_limits<std::ptrdiff_t>::max();
+				if (!linked(e, curr.next) || (!invalid && !linked(e, curr.prev)))
+					throw std::runtime_error("snapshot handle list out of range");
+			}
+
+			replace(staged);
+		}
+
+		/// @brief swaps the handles with those of other in O(1), eg to commit handles loaded off to the side. other must 
+		/// allocate from the same resource. records an update event for every new node, other records none.
+		void replace(HandleManager& other) {
+			m_nodes.swap(other.m_nodes);
+			std::swap(m_begin, other.m_begin);
+			std::swap(m_end, other.m_end);
+			recordAll(Event::Update);
+		}
+
+		/// @brief writes the nodes of the changed entities and both list heads, the nodes an entity's creation, erasure or 
+		/// update touches are all recorded as events so the changed set of a collector on this pool is sufficient.
+		void saveDelta(ByteWriter& writer, std::span<const Entity> changed) const {
+			writer.write(uint64_t{ m_nodes.size() });
+			writer.write(m_begin);
+			writer.write(m_end);
+
+			uint64_t count = std::count_if(changed.begin(), changed.end(), [&](Entity e) { return e < m_nodes.size(); });
+			writer.write(count);
+			for (Entity e : changed)
+			{
+				if (e >= m_nodes.size())
+					continue;
+
+				writer.write(e);
+				writer.write(m_nodes[e]);
+			}
+		}
+
+		/// @brief applies a delta written by saveDelta. records construct for entities that became valid, destroy for those
+		/// that became invalid and update for the other nodes written.
+		void loadDelta(ByteReader& reader) {
+			constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+			uint64_t size = reader.read<uint64_t>();
+			uint32_t begin = reader.read<uint32_t>();
+			uint32_t end = reader.read<uint32_t>();
+			if ((begin != none && begin >= size) || (end != none && end >= size))
+				throw std::runtime_error("delta handle list out of range");
+
+			m_nodes.resize(size, node{ std::numeric_limits<std::ptrdiff_t>::max(), 0 });
+			m_begin = begin;
+			m_end = end;
+
+			uint64_t count = reader.read<uint64_t>();
+			for (uint64_t i = 0; i < count; i++)
+			{
+				Entity e = reader.read<Entity>();
+				if (e >= size)
+					throw std::runtime_error("delta entity out of range");
+
+				bool wasValid = valid(e);
+				m_nodes[e] = reader.read<node>();
+
+				if (wasValid == valid(e))
+					signal(Event::Update).record(e);
+				else
+					signal(valid(e) ? Event::Construct : Event::Destroy).record(e);
+			}
+		}
+
+		/// @brief reserves nodes for count entities.
+		void reserve(size_t count) {
+			m_nodes.reserve(count);
+		}
+
+		/// @brief listeners are invoked with each batch of events after the pipeline that recorded them releases its access.
+		const Signal& on(Event event) const {
+			return m_signals[static_cast<size_t>(event)];
+		}
+
+		/// @brief hands off the events recorded since the last call, requires write access.
+		EventBatch takeEvents() {
+			return { m_signals[0].take(), m_signals[1].take(), m_signals[2].take() };
+		}
+
 	private:
-		std::vector<node> m_nodes;
+		Signal& signal(Event event) {
+			return m_signals[static_cast<size_t>(event)];
+		}
+
+		void recordAll(Event event) {
+			for (Entity e = 0; e < m_nodes.size(); e++)
+				signal(event).record(e);
+		}
+
+		std::pmr::vector<node> m_nodes;
 		uint32_t m_begin{ std::numeric_limits<uint32_t>::max() };
 		uint32_t m_end{ std::numeric_limits<uint32_t>::max() };
+		std::array<Signal, 3> m_signals;
 	};
 }
@@ -0,0 +1,291 @@
+#pragma once
+#include "Entity.h"
+#include "Filters.h"
+#include "Collector.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Gawr::ECS {
+	/// @brief index flavour for equality lookups, O(1) per lookup and change.
+	struct Hashed { };
+
+	/// @brief index flavour for range lookups, a sorted array with O(log n) lookups. changes are sorted and merged in on the
+	/// next lookup, O(n + changes * log changes).
+	struct Ordered { };
+
+	template<typename T, typename KeyFn, typename Order_T = Hashed>
+	class Index;
+
+	namespace internal {
+		/// @brief the entities found by an index lookup. keeps the state of the index it was found in alive, so the entities 
+		/// stay valid while the index changes.
+		class IndexResult {
+		public:
+			IndexResult(std::shared_ptr<const void> state, std::span<const Entity> entities)
+				: m_state(std::move(state)), m_entities(entities)
+			{ }
+
+			auto begin() const { return m_entities.begin(); }
+			auto end() const { return m_entities.end(); }
+			size_t size() const { return m_entities.size(); }
+			bool empty() const { return m_entities.empty(); }
+
+			operator std::span<const Entity>() const { return m_entities; }
+
+		private:
+			std::shared_ptr<const void>	m_state;
+			std::span<const Entity>		m_entities;
+		};
+
+		// keeps the index state up to date with the changes collected from the pool. changes are applied on lookup through
+		// the caller's pipeline so the index never needs access of its own. state referenced by a result is copied before
+		// it is changed, otherwise changed in place.
+		template<typename T, typename State_T>
+		class IndexTracker {
+		public:
+			template<typename Pip_T>
+			IndexTracker(Pip_T& pipeline) : m_collector(pipeline), m_state(std::make_shared<State_T>()) {
+				auto& pool = pipeline.template pool<const T>();
+
+				std::vector<Entity> entities(pool.begin(), pool.end());
+				m_state->apply(pool, entities);
+			}
+
+			IndexTracker(const IndexTracker&) = delete;
+			IndexTracker& operator=(const IndexTracker&) = delete;
+
+			template<typename Pip_T>
+			std::shared_ptr<const State_T> acquire(Pip_T& pipeline) {
+				std::lock_guard guard(m_mtx);
+				if (m_collector.size() > 0)
+				{
+					m_collector.drain(m_changes);
+
+					// only copies made under the lock can be referenced, so a unique state is not referenced by any result
+					if (m_state.use_count() > 1)
+						m_state = std::make_shared<State_T>(*m_state);
+
+					m_state->apply(pipeline.template pool<const T>(), m_changes);
+				}
+				return m_state;
+			}
+
+		private:
+			Collector<Where<AllOf<T>>>	m_collector;
+			std::vector<Entity>			m_changes;
+			std::mutex					m_mtx;
+			std::shared_ptr<State_T>	m_state;
+		};
+	}
+
+	/// @brief a hashed secondary index from a key of component T to the entities with that key, eg entities by material.
+	/// built from the pool on construction and kept up to date through the pool's signals, lookups reflect every change
+	/// dispatched before the lookup. only changes the pool signals are tracked, ie emplace, erase and update(e), a component
+	/// written in place without update stays under its old key. the index must not outlive the registry it was built from.
+	/// @tparam KeyFn default constructible, invoked with const T& and returns a hashable key
+	template<typename T, typename KeyFn>
+	class Index<T, KeyFn, Hashed> {
+	public:
+		using Key = std::remove_cvref_t<std::invoke_result_t<KeyFn, const T&>>;
+
+	private:
+		struct State {
+			template<typename Pool_T>
+			void apply(const Pool_T& pool, std::span<const Entity> changes) {
+				for (Entity e : changes)
+				{
+					if (e < m_keys.size() && m_keys[e])
+					{
+						if (pool.contains(e) && *m_keys[e] == KeyFn{}(pool.getComponent(e)))
+							continue;
+
+						erase(e);
+					}
+
+					if (pool.contains(e))
+						insert(e, KeyFn{}(pool.getComponent(e)));
+				}
+			}
+
+			void insert(Entity e, const Key& key) {
+				if (m_keys.size() <= e)
+				{
+					m_keys.resize(e + 1);
+					m_positions.resize(e + 1, tombstone);
+				}
+
+				std::vector<Entity>& bucket = m_buckets[key];
+				m_positions[e] = static_cast<Entity>(bucket.size());
+				m_keys[e] = key;
+				bucket.push_back(e);
+			}
+
+			// swap and pop from the bucket
+			void erase(Entity e) {
+				auto it = m_buckets.find(*m_keys[e]);
+				std::vector<Entity>& bucket = it->second;
+
+				Entity back = bucket.back();
+				bucket[m_positions[e]] = back;
+				m_positions[back] = m_positions[e];
+				bucket.pop_back();
+
+				if (bucket.empty())
+					m_buckets.erase(it);
+
+				m_keys[e].reset();
+				m_positions[e] = tombstone;
+			}
+
+			std::unordered_map<Key, std::vector<Entity>>	m_buckets;
+			std::vector<std::optional<Key>>					m_keys;			// by entity
+			std::vector<Entity>								m_positions;	// by entity, index in bucket
+		};
+
+	public:
+		/// @param pipeline any pipeline with access to T, read access is sufficient
+		template<typename Pip_T>
+		Index(Pip_T& pipeline) : m_tracker(pipeline) { }
+
+		/// @brief the entities whose key equals key, in O(1).
+		/// @param pipeline any pipeline with access to T, read access is sufficient
+		template<typename Pip_T>
+		internal::IndexResult find(Pip_T& pipeline, const Key& key) {
+			auto state = m_tracker.acquire(pipeline);
+
+			auto it = state->m_buckets.find(key);
+			if (it == state->m_buckets.end())
+				return { std::move(state), { } };
+
+			std::span<const Entity> entities = it->second;
+			return { std::move(state), entities };
+		}
+
+	private:
+		internal::IndexTracker<T, State> m_tracker;
+	};
+
+	/// @brief an ordered secondary index from a key of component T to the entities with that key, eg entities by depth.
+	/// built from the pool on construction and kept up to date through the pool's signals, lookups reflect every change
+	/// dispatched before the lookup. only changes signalled through emplace, erase or update(e) are tracked, so a system 
+	/// writing T in place must call update for each entity it writes, as the hierarchy systems do for Parent::m_depth. the
+	/// index must not outlive the registry it was built from.
+	/// @tparam KeyFn default constructible, invoked with const T& and returns a key ordered by operator<
+	template<typename T, typename KeyFn>
+	class Index<T, KeyFn, Ordered> {
+	public:
+		using Key = std::remove_cvref_t<std::invoke_result_t<KeyFn, const T&>>;
+
+	private:
+		struct State {
+			// removes the changed entities, then merges their new keys back in sorted
+			template<typename Pool_T>
+			void apply(const Pool_T& pool, std::span<const Entity> changes) {
+				for (Entity e : changes)
+				{
+					if (m_changed.size() <= e)
+						m_changed.resize(e + 1, 0);
+
+					m_changed[e] = 1;
+				}
+
+				size_t kept = 0;
+				for (size_t i = 0; i < m_entities.size(); i++)
+				{
+					if (m_entities[i] < m_changed.size() && m_changed[m_entities[i]])
+						continue;
+
+					m_keys[kept] = std::move(m_keys[i]);
+					m_entities[kept] = m_entities[i];
+					kept++;
+				}
+
+				m_keys.erase(m_keys.begin() + kept, m_keys.end());
+				m_entities.resize(kept);
+
+				std::vector<std::pair<Key, Entity>> inserted;
+				for (Entity e : changes)
+				{
+					m_changed[e] = 0;
+					if (pool.contains(e))
+						inserted.emplace_back(KeyFn{}(pool.getComponent(e)), e);
+				}
+
+				std::sort(inserted.begin(), inserted.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+				std::vector<Key> keys;
+				std::vector<Entity> entities;
+				keys.reserve(kept + inserted.size());
+				entities.reserve(kept + inserted.size());
+
+				size_t i = 0, j = 0;
+				while (i < kept || j < inserted.size())
+				{
+					if (j == inserted.size() || (i < kept && !(inserted[j].first < m_keys[i])))
+					{
+						keys.push_back(std::move(m_keys[i]));
+						entities.push_back(m_entities[i++]);
+					}
+					else
+					{
+						keys.push_back(std::move(inserted[j].first));
+						entities.push_back(inserted[j++].second);
+					}
+				}
+
+				m_keys = std::move(keys);
+				m_entities = std::move(entities);
+			}
+
+			std::span<const Entity> entities(typename std::vector<Key>::const_iterator first, typename std::vector<Key>::const_iterator last) const {
+				return std::span<const Entity>(m_entities).subspan(first - m_keys.cbegin(), last - first);
+			}
+
+			std::vector<Key>		m_keys;		// sorted
+			std::vector<Entity>		m_entities;	// parallel to m_keys
+			std::vector<uint8_t>	m_changed;	// by entity, scratch for apply
+		};
+
+	public:
+		/// @param pipeline any pipeline with access to T, read access is sufficient
+		template<typename Pip_T>
+		Index(Pip_T& pipeline) : m_tracker(pipeline) { }
+
+		/// @brief the entities whose key equals key, in O(log n).
+		template<typename Pip_T>
+		internal::IndexResult find(Pip_T& pipeline, const Key& key) {
+			auto state = m_tracker.acquire(pipeline);
+			auto [first, last] = std::equal_range(state->m_keys.cbegin(), state->m_keys.cend(), key);
+			std::span<const Entity> entities = state->entities(first, last);
+			return { std::move(state), entities };
+		}
+
+		/// @brief the entities with a key in [min, max), ordered by key, in O(log n).
+		template<typename Pip_T>
+		internal::IndexResult range(Pip_T& pipeline, const Key& min, const Key& max) {
+			auto state = m_tracker.acquire(pipeline);
+			auto first = std::lower_bound(state->m_keys.cbegin(), state->m_keys.cend(), min);
+			auto last = std::lower_bound(first, state->m_keys.cend(), max);
+			std::span<const Entity> entities = state->entities(first, last);
+			return { std::move(state), entities };
+		}
+
+		/// @brief every indexed entity ordered by key.
+		template<typename Pip_T>
+		internal::IndexResult all(Pip_T& pipeline) {
+			auto state = m_tracker.acquire(pipeline);
+			std::span<const Entity> entities = state->m_entities;
+			return { std::move(state), entities };
+		}
+
+	private:
+		internal::IndexTracker<T, State> m_tracker;
+	};
+}
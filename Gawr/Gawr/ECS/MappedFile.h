@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Gawr::ECS {
+	/// @brief a read only view of a whole file mapped into memory. pages are read in by the os on first access, so opening is
+	/// O(1) regardless of file size.
+	class MappedFile {
+	public:
+		explicit MappedFile(const std::filesystem::path& path) {
+#if defined(_WIN32)
+			HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				throw std::runtime_error("cannot open mapped file");
+
+			LARGE_INTEGER size;
+			GetFileSizeEx(file, &size);
+			m_size = static_cast<size_t>(size.QuadPart);
+
+			if (m_size > 0)
+			{
+				HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping)
+				{
+					m_data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+					CloseHandle(mapping);	// the view keeps the mapping alive
+				}
+			}
+			CloseHandle(file);
+#else
+			int file = open(path.c_str(), O_RDONLY);
+			if (file < 0)
+				throw std::runtime_error("cannot open mapped file");
+
+			struct stat info;
+			fstat(file, &info);
+			m_size = static_cast<size_t>(info.st_size);
+
+			if (m_size > 0)
+			{
+				void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+				if (data != MAP_FAILED)
+				{
+					m_data = static_cast<const std::byte*>(data);
+					madvise(data, m_size, MADV_SEQUENTIAL);
+				}
+			}
+			close(file);
+#endif
+			if (m_size > 0 && !m_data)
+				throw std::runtime_error("cannot map file");
+		}
+
+		~MappedFile() {
+			if (!m_data)
+				return;
+#if defined(_WIN32)
+			UnmapViewOfFile(m_data);
+#else
+			munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+		}
+
+		MappedFile(MappedFile&& other) noexcept
+			: m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0))
+		{ }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&&) = delete;
+
+		std::span<const std::byte> bytes() const {
+			return { m_data, m_size };
+		}
+
+		size_t size() const {
+			return m_size;
+		}
+
+	private:
+		const std::byte*	m_data = nullptr;
+		size_t				m_size = 0;
+	};
+}
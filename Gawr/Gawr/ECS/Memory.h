@@ -0,0 +1,191 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Gawr::ECS {
+	/// @brief an arena for short lived registries. deallocation is a no-op and every allocation is released at once when the
+	/// arena is destroyed, so tearing down a registry does not return its pools allocation by allocation. pools of one
+	/// registry grow from different threads under their own locks so allocation is serialised. a growing pool leaves its
+	/// old buffers behind, reserve pools of known size up front.
+	class MonotonicArena : public std::pmr::memory_resource {
+	public:
+		explicit MonotonicArena(size_t initialSize = size_t{ 1 } << 20, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+			: m_arena(initialSize, upstream)
+		{ }
+
+		MonotonicArena(const MonotonicArena&) = delete;
+		MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+		/// @brief releases every allocation, registries built in the arena must be destroyed first.
+		void release() {
+			std::lock_guard guard(m_mtx);
+			m_arena.release();
+		}
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override {
+			std::lock_guard guard(m_mtx);
+			return m_arena.allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void*, size_t, size_t) override { }
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			return this == &other;
+		}
+
+		std::mutex							m_mtx;
+		std::pmr::monotonic_buffer_resource m_arena;
+	};
+
+	/// @brief an arena for long lived registries. freed blocks are kept in size classes and reused by later growth of any
+	/// pool using the arena, so pools growing and shrinking over time do not fragment the heap. thread safe.
+	using PoolArena = std::pmr::synchronized_pool_resource;
+
+	/// @brief a bump allocator for scratch data owned by a single thread. allocation is a pointer increment, deallocation is
+	/// a no-op and reset releases everything in O(1). when a frame overflows the block more blocks are taken from upstream,
+	/// and merged into one block large enough for the whole frame on the next reset, so a steady workload stops allocating.
+	class alignas(64) LinearArena : public std::pmr::memory_resource {
+	public:
+		explicit LinearArena(size_t capacity = size_t{ 1 } << 16, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+			: m_upstream(upstream)
+		{
+			addBlock(capacity);
+		}
+
+		~LinearArena() {
+			releaseBlocks();
+		}
+
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		/// @brief releases every allocation, containers using the arena must be destroyed or no longer used.
+		void reset() {
+			if (m_blocks.size() > 1)
+			{
+				size_t capacity = this->capacity();
+				releaseBlocks();
+				addBlock(capacity);
+			}
+
+			m_head = m_blocks.back().m_data;
+			m_end = m_head + m_blocks.back().m_size;
+			m_used = 0;
+		}
+
+		/// @brief bytes allocated since the last reset, including alignment padding
+		size_t used() const {
+			return m_used;
+		}
+
+		size_t capacity() const {
+			size_t capacity = 0;
+			for (const Block& block : m_blocks)
+				capacity += block.m_size;
+			return capacity;
+		}
+
+	private:
+		struct Block {
+			std::byte*	m_data;
+			size_t		m_size;
+		};
+
+		void addBlock(size_t size) {
+			m_blocks.push_back({ static_cast<std::byte*>(m_upstream->allocate(size, alignof(std::max_align_t))), size });
+			m_head = m_blocks.back().m_data;
+			m_end = m_head + size;
+		}
+
+		void releaseBlocks() {
+			for (const Block& block : m_blocks)
+				m_upstream->deallocate(block.m_data, block.m_size, alignof(std::max_align_t));
+			m_blocks.clear();
+		}
+
+		void* do_allocate(size_t bytes, size_t alignment) override {
+			size_t padding = (alignment - reinterpret_cast<uintptr_t>(m_head) % alignment) % alignment;
+			if (bytes + padding > size_t(m_end - m_head))
+			{
+				addBlock(std::max(bytes + alignment, m_blocks.back().m_size * 2));
+				padding = (alignment - reinterpret_cast<uintptr_t>(m_head) % alignment) % alignment;
+			}
+
+			std::byte* ptr = m_head + padding;
+			m_head = ptr + bytes;
+			m_used += padding + bytes;
+			return ptr;
+		}
+
+		void do_deallocate(void*, size_t, size_t) override { }
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			return this == &other;
+		}
+
+		std::pmr::memory_resource*	m_upstream;
+		std::vector<Block>			m_blocks;	// last is current
+		std::byte*					m_head = nullptr;
+		std::byte*					m_end = nullptr;
+		size_t						m_used = 0;
+	};
+
+	/// @brief scratch memory for systems, one linear arena per worker thread per frame in flight. data allocated during a 
+	/// frame stays valid until the same frame index begins again, so it may be read by the gpu or another thread while 
+	/// later frames are recorded.
+	class FrameAllocator {
+	public:
+		/// @param frames frames in flight, eg 2 for double buffering
+		/// @param workers worker threads that allocate during a frame, each gets its own arena so allocation is lock free
+		/// @param capacity initial bytes per arena, arenas grow to fit their largest frame
+		explicit FrameAllocator(size_t frames, size_t workers = std::max<size_t>(std::thread::hardware_concurrency(), 1), size_t capacity = size_t{ 1 } << 16)
+			: m_frames(frames), m_workers(workers)
+		{
+			m_arenas.reserve(frames * workers);
+			for (size_t i = 0; i < frames * workers; i++)
+				m_arenas.push_back(std::make_unique<LinearArena>(capacity));
+		}
+
+		/// @brief resets the arenas of frame, O(workers), and makes it current. the previous contents of the frame must no 
+		/// longer be in use, eg after waiting on its fence.
+		void beginFrame(size_t frame) {
+			m_current = frame % m_frames;
+			for (size_t worker = 0; worker < m_workers; worker++)
+				arena(m_current, worker).reset();
+		}
+
+		/// @brief the current frame's arena for worker, only that worker may allocate from it.
+		std::pmr::memory_resource* resource(size_t worker = 0) {
+			return &arena(m_current, worker);
+		}
+
+		size_t workers() const {
+			return m_workers;
+		}
+
+		/// @brief bytes allocated in the current frame across every worker
+		size_t used() const {
+			size_t used = 0;
+			for (size_t worker = 0; worker < m_workers; worker++)
+				used += m_arenas[m_current * m_workers + worker]->used();
+			return used;
+		}
+
+	private:
+		LinearArena& arena(size_t frame, size_t worker) {
+			return *m_arenas[frame * m_workers + worker];
+		}
+
+		size_t m_frames;
+		size_t m_workers;
+		size_t m_current = 0;
+		std::vector<std::unique_ptr<LinearArena>> m_arenas;	// frame major
+	};
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Gawr::ECS::internal {
+	/// @brief the number of chunks to split count elements into so each chunk has at least minChunk elements and there is at
+	/// most one chunk per hardware thread.
+	inline size_t chunkCount(size_t count, size_t minChunk = 4096) {
+		return std::clamp<size_t>(count / minChunk, 1, std::max<size_t>(std::thread::hardware_concurrency(), 1));
+	}
+
+	/// @brief calls func(chunk, begin, end) for each of chunks contiguous ranges of [0, count), one thread per chunk. the
+	/// calling thread runs the first chunk. chunk boundaries depend only on count and chunks so passes over the same data
+	/// see the same ranges.
+	template<typename Func_T>
+	void parallelChunks(size_t count, size_t chunks, Func_T func) {
+		auto run = [&](size_t chunk) { func(chunk, count * chunk / chunks, count * (chunk + 1) / chunks); };
+
+		std::vector<std::jthread> workers;
+		for (size_t chunk = 1; chunk < chunks; chunk++)
+			workers.emplace_back(run, chunk);
+
+		run(0);
+	}
+
+	/// @brief the unsigned type an integral key is radix sorted as, bool as a byte.
+	template<typename Key_T>
+	struct RadixKey { using type = std::make_unsigned_t<Key_T>; };
+
+	template<>
+	struct RadixKey<bool> { using type = uint8_t; };
+
+	/// @brief stable least significant digit radix sort of keys, values are moved with their keys. each pass histograms and 
+	/// scatters the chunks in parallel, passes where every key has the same digit are skipped.
+	template<typename Key_T, typename Value_T>
+	void radixSort(std::vector<Key_T>& keys, std::vector<Value_T>& values, size_t chunks) {
+		static_assert(std::is_unsigned_v<Key_T>, "radix sort requires unsigned keys");
+
+		size_t count = keys.size();
+		std::vector<Key_T> keysOut(count);
+		std::vector<Value_T> valuesOut(count);
+		std::vector<std::array<size_t, 256>> offsets(chunks);
+
+		for (size_t shift = 0; shift < sizeof(Key_T) * 8; shift += 8)
+		{
+			parallelChunks(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+				auto& histogram = offsets[chunk];
+				histogram.fill(0);
+				for (size_t i = begin; i < end; i++)
+					histogram[(keys[i] >> shift) & 0xff]++;
+			});
+
+			// exclusive prefix sum digit major, so each chunk scatters after the earlier chunks with the same digit
+			size_t total = 0;
+			bool uniform = false;
+			for (size_t digit = 0; digit < 256; digit++)
+			{
+				size_t first = total;
+				for (auto& histogram : offsets)
+				{
+					size_t n = histogram[digit];
+					histogram[digit] = total;
+					total += n;
+				}
+				uniform |= (total - first == count);
+			}
+
+			if (uniform)
+				continue;
+
+			parallelChunks(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+				auto& offset = offsets[chunk];
+				for (size_t i = begin; i < end; i++)
+				{
+					size_t dst = offset[(keys[i] >> shift) & 0xff]++;
+					keysOut[dst] = keys[i];
+					valuesOut[dst] = values[i];
+				}
+			});
+
+			std::swap(keys, keysOut);
+			std::swap(values, valuesOut);
+		}
+	}
+}
@@ -31,20 +31,29 @@ namespace Gawr::ECS {
 		Pipeline(Registry& reg) : m_reg(reg)
 		{
 			// for each type in reg -> orderedby registry so consistent locking order
-			([&]<typename U>()->void
-			{
-				if constexpr (stored_as_non_const<U>)
-					m_reg.pool<U>().lock();
-
-				else if constexpr (stored_as_const<U>)
-					m_reg.pool<const U>().lock();
-
-			}.operator()<Reg_Ts>(), ...);
+			(lock<Reg_Ts>(), ...);
 		}
 
 		~Pipeline() {
+			// take events while access is held, dispatch after release so listeners may acquire their own pipelines
+			std::array<EventBatch, sizeof...(Ts)> events{ takeEvents<Ts>()... };
+
+			// counted before release so a reader that acquires the pools next can tell the events are still in flight
+			constexpr bool writes = (!std::is_const_v<Ts> || ...);
+			if constexpr (writes)
+				m_reg.m_dispatching.fetch_add(1, std::memory_order_relaxed);
+
 			// unlock all, order doesnt matter
-			(m_reg.pool<Ts>().unlock(), ...);
+			(m_reg.template pool<Ts>().unlock(), ...);
+
+			for (auto& batch : events)
+				batch.dispatch();
+
+			if constexpr (writes)
+			{
+				if (m_reg.m_dispatching.fetch_sub(1, std::memory_order_release) == 1)
+					m_reg.m_dispatching.notify_all();
+			}
 		}
 
 		Pipeline(const Pipeline&) = delete;
@@ -65,7 +74,34 @@ namespace Gawr::ECS {
 		{
 			return View<Select_T, From_T, Where_T>{ *this };
 		}
+
+		/// @brief a view over the given entities rather than a pool, eg the result of an index lookup.
+		template<typename Select_T,
+			typename Where_T = internal::DefaultWhere<Select_T, From<Entity>>::type>
+		auto view(std::span<const Entity> entities)
+		{
+			return View<Select_T, FromEntities, Where_T>{ *this, FromEntities{ entities } };
+		}
 	private:
+		// a member rather than a templated lambda in the constructor, gcc does not see the class's variable
+		// templates from inside one
+		template<typename U>
+		void lock() {
+			if constexpr (stored_as_non_const<U>)
+				m_reg.template pool<U>().lock();
+
+			else if constexpr (stored_as_const<U>)
+				m_reg.template pool<const U>().lock();
+		}
+
+		template<typename U>
+		EventBatch takeEvents() {
+			if constexpr (std::is_const_v<U>)
+				return { };
+			else
+				return m_reg.template pool<U>().takeEvents();
+		}
+
 		Registry& m_reg;
 	};
 }
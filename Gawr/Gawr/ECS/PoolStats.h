@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace Gawr::ECS {
+	/// @brief memory used by a single pool. used counts the live elements of each array, reserved counts their capacity.
+	struct PoolStats {
+		size_t m_count = 0;			// components, live handles or pairs
+		size_t m_sparse = 0;		// entries in the entity lookup
+		size_t m_tombstones = 0;	// entries in the entity lookup that are not in use
+		size_t m_bytesUsed = 0;
+		size_t m_bytesReserved = 0;
+
+		/// @brief fraction of the entity lookup in use, low after mass destruction or with few high ids
+		float sparseFill() const {
+			return m_sparse == 0 ? 1.0f : float(m_sparse - m_tombstones) / float(m_sparse);
+		}
+
+		/// @brief bytes that shrink could return
+		size_t slack() const {
+			return m_bytesReserved - m_bytesUsed;
+		}
+	};
+
+	/// @brief memory used by every pool of a registry, against an optional budget.
+	struct MemoryReport {
+		struct Entry {
+			std::string_view m_name;
+			PoolStats		 m_stats;
+		};
+
+		std::vector<Entry> m_pools;
+		size_t m_bytesUsed = 0;
+		size_t m_bytesReserved = 0;
+		size_t m_budget = 0;	// 0 is unlimited
+
+		bool overBudget() const {
+			return m_budget != 0 && m_bytesReserved > m_budget;
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const MemoryReport& report) {
+			for (const Entry& entry : report.m_pools)
+			{
+				out << entry.m_name << ": " << entry.m_stats.m_count << " entries, "
+					<< entry.m_stats.m_bytesUsed << " / " << entry.m_stats.m_bytesReserved << " bytes, "
+					<< "sparse fill " << entry.m_stats.sparseFill() * 100.0f << "%, "
+					<< entry.m_stats.m_tombstones << " tombstones\n";
+			}
+
+			out << "total: " << report.m_bytesUsed << " / " << report.m_bytesReserved << " bytes";
+			if (report.m_budget != 0)
+				out << " of " << report.m_budget << (report.overBudget() ? " budget, over" : " budget");
+			return out << '\n';
+		}
+	};
+}
@@ -1,12 +1,41 @@
 #pragma once
 #include "Entity.h"
+#include "PoolStats.h"
+#include "Memory.h"
+#include "Snapshot.h"
+
+#include <atomic>
+#include <filesystem>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <typeinfo>
 
 namespace Gawr::ECS {
 	// access managed classes
 	template<typename T> 
 	class Storage;
+	template<typename R>
+	class RelationStorage;
 	class HandleManager;
 
+	template<typename R>
+	struct Relation;
+
+	namespace internal {
+		template<typename T>
+		struct StorageOf { using type = Storage<T>; };
+
+		template<typename R>
+		struct StorageOf<Relation<R>> { using type = RelationStorage<R>; };
+
+		template<typename T>
+		struct IsRelation : std::false_type { };
+
+		template<typename R>
+		struct IsRelation<Relation<R>> : std::true_type { };
+	}
+
 	template<typename ... Ts>
 	class Registry {
 	public:
@@ -14,20 +43,243 @@ namespace Gawr::ECS {
 		class Pipeline;
 		
 		template<typename U>
-		using Pool = std::conditional_t<std::is_same_v<std::remove_const_t<U>, Entity>, HandleManager, Storage<std::remove_const_t<U>>>;
+		using Pool = std::conditional_t<std::is_same_v<std::remove_const_t<U>, Entity>, HandleManager, typename internal::StorageOf<std::remove_const_t<U>>::type>;
 
 	private:
-		using storage_collection_t = std::tuple<HandleManager, Storage<Ts>...>;
+		using storage_collection_t = std::tuple<HandleManager, typename internal::StorageOf<Ts>::type...>;
 
 		template<typename U>
 		using pool_reference_t = std::conditional_t<std::is_const_v<U>, const Pool<U>&, Pool<U>&>;
 	
+		template<typename>
+		static std::pmr::memory_resource* poolResource(std::pmr::memory_resource* resource) {
+			return resource;
+		}
+	
 	public:
+		/// @param resource backs every pool of the registry and must outlive it, eg a MonotonicArena for short lived 
+		/// registries or a PoolArena for long lived ones
+		explicit Registry(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			: m_resource(resource), m_pools(resource, poolResource<Ts>(resource)...)
+		{ }
+
+		std::pmr::memory_resource* resource() const {
+			return m_resource;
+		}
+
+		/// @brief true while a write pipeline has released its pools but not yet dispatched its events, eg a collector has
+		/// not seen changes already visible in the pools. checked under read access to every pool it is false only once 
+		/// every listener has seen every change to the pools.
+		bool dispatching() const {
+			return m_dispatching.load(std::memory_order_acquire) != 0;
+		}
+
+		/// @brief blocks until no write pipeline is dispatching its events. must not be called from a listener, the 
+		/// dispatch calling it would never finish.
+		void waitForDispatch() const {
+			for (uint32_t count = m_dispatching.load(std::memory_order_acquire); count != 0; count = m_dispatching.load(std::memory_order_acquire))
+				m_dispatching.wait(count, std::memory_order_acquire);
+		}
+
 		template<typename ... Us>
 		auto pipeline() {
 			return Pipeline<Us...>{ *this };
 		}
 
+		/// @brief removes the entities from every pool, including relations where they are either end, and releases their 
+		/// handles. acquires write access to every pool.
+		void destroy(std::span<const Entity> entities) {
+			static_assert((std::is_same_v<Ts, Entity> || ...), "registry does not manage entity handles");
+
+			auto pip = pipeline<Ts...>();
+			([&]<typename U>()
+			{
+				if constexpr (!std::is_same_v<U, Entity>)
+				{
+					auto& pool = pip.template pool<U>();
+					for (Entity e : entities)
+					{
+						if constexpr (internal::IsRelation<U>::value)
+							pool.remove(e);
+						else if (pool.contains(e))
+							pool.remove(e);
+					}
+				}
+			}.template operator()<Ts>(), ...);
+
+			auto& handles = pip.template pool<Entity>();
+			for (Entity e : entities)
+			{
+				if (handles.valid(e))
+					handles.erase(e);
+			}
+		}
+
+		/// @brief the result of a compaction
+		struct Compaction {
+			EntityRemap m_remap;	// old to new entity, for entities held outside the registry
+			size_t m_memoryBefore;	// bytes allocated by every pool
+			size_t m_memoryAfter;
+		};
+
+		/// @brief renumbers the live entities into a dense prefix and rewrites every pool, the sparse arrays shrink to the new
+		/// highest id. components with a remap(const EntityRemap&) member have their entity references remapped, entities
+		/// held anywhere else, including collectors and indexes, must be remapped or rebuilt by the caller. acquires write 
+		/// access to every pool.
+		Compaction compact() {
+			static_assert((std::is_same_v<Ts, Entity> || ...), "registry does not manage entity handles");
+
+			auto pip = pipeline<Ts...>();
+			auto memory = [&]() { return (pip.template pool<Ts>().stats().m_bytesReserved + ...); };
+
+			Compaction result{ .m_memoryBefore = memory() };
+			result.m_remap = pip.template pool<Entity>().compact();
+
+			([&]<typename U>()
+			{
+				if constexpr (!std::is_same_v<U, Entity>)
+					pip.template pool<U>().remap(result.m_remap);
+			}.template operator()<Ts>(), ...);
+
+			result.m_memoryAfter = memory();
+			return result;
+		}
+
+		/// @brief replaces every pool of target with a copy of this registry's, eg a render or speculative copy of the 
+		/// simulation. target's allocations are reused so cloning into the same target every frame stops allocating once it
+		/// has grown, trivially copyable arrays are copied in bulk. acquires read access to every pool and write access to 
+		/// every pool of target, two registries must not be cloned into each other concurrently.
+		void clone(Registry& target) {
+			if (&target == this)
+				return;
+
+			auto src = pipeline<const Ts...>();
+			auto dst = target.pipeline<Ts...>();
+			(dst.template pool<Ts>().copy(src.template pool<const Ts>()), ...);
+		}
+
+		/// @brief adds every entity of other under a new handle, eg a scene chunk loaded into a staging registry in the 
+		/// background. each pool is appended in one pass rather than entity by entity, components and relations holding 
+		/// entities of other are remapped as in compact. other is unchanged. acquires read access to every pool of other and 
+		/// write access to every pool, two registries must not be merged into each other concurrently.
+		/// @return other's entities to their new ids
+		EntityRemap merge(Registry& other) {
+			static_assert((std::is_same_v<Ts, Entity> || ...), "registry does not manage entity handles");
+			if (&other == this)
+				throw std::runtime_error("cannot merge a registry into itself");
+
+			auto src = other.pipeline<const Ts...>();
+			auto dst = pipeline<Ts...>();
+
+			// handles are created back to front so the merged entities keep their relative iteration order
+			auto& from = src.template pool<const Entity>();
+			auto& handles = dst.template pool<Entity>();
+
+			std::vector<Entity> order;
+			for (auto it = from.begin(); it != from.end(); ++it)
+				order.push_back(*it);
+
+			EntityRemap remap{ std::vector<Entity>(from.stats().m_sparse, tombstone) };
+			for (auto it = order.rbegin(); it != order.rend(); ++it)
+				remap.m_table[*it] = handles.create();
+
+			([&]<typename U>()
+			{
+				if constexpr (!std::is_same_v<U, Entity>)
+					dst.template pool<U>().merge(src.template pool<const U>(), remap);
+			}.template operator()<Ts>(), ...);
+
+			return remap;
+		}
+
+		/// @brief memory used by every pool, pools are named by their type. the registry is over budget when the bytes 
+		/// reserved exceed budget, 0 is unlimited. acquires read access to every pool.
+		MemoryReport memoryReport(size_t budget = 0) {
+			auto pip = pipeline<const Ts...>();
+
+			MemoryReport report{ .m_budget = budget };
+			([&]<typename U>()
+			{
+				PoolStats stats = pip.template pool<const U>().stats();
+				report.m_bytesUsed += stats.m_bytesUsed;
+				report.m_bytesReserved += stats.m_bytesReserved;
+				report.m_pools.push_back({ std::is_same_v<U, Entity> ? "Entity" : typeid(U).name(), stats });
+			}.template operator()<Ts>(), ...);
+
+			return report;
+		}
+
+		/// @brief shrinks every pool with more than slack bytes reserved beyond its used bytes, 0 shrinks every pool. 
+		/// references to components are invalidated. acquires write access to every pool.
+		/// @return bytes released
+		size_t shrink(size_t slack = 0) {
+			auto pip = pipeline<Ts...>();
+
+			size_t released = 0;
+			([&]<typename U>()
+			{
+				auto& pool = pip.template pool<U>();
+				size_t before = pool.stats().m_bytesReserved;
+				if (slack == 0 || before - pool.stats().m_bytesUsed > slack)
+				{
+					pool.shrink();
+					released += before - pool.stats().m_bytesReserved;
+				}
+			}.template operator()<Ts>(), ...);
+
+			return released;
+		}
+
+		/// @brief writes every pool to a snapshot file at path. acquires read access to every pool.
+		void save(const std::filesystem::path& path) {
+			auto pip = pipeline<const Ts...>();
+
+			SnapshotWriter writer(path, sizeof...(Ts));
+			([&]<typename U>()
+			{
+				writer.beginPool<U>();
+				pip.template pool<const U>().save(writer);
+			}.template operator()<Ts>(), ...);
+
+			writer.finish();
+		}
+
+		/// @brief replaces every pool with a snapshot saved by a registry of the same types. the file is mapped and each
+		/// trivially copyable array is copied in bulk, so loading is bound by page in rather than parsing. throws 
+		/// std::runtime_error if the file is not a snapshot of this registry or any pool is truncated or out of range, the 
+		/// pools are unchanged in that case. every pool is read into a staging registry and swapped in once all have 
+		/// loaded, so write access to every pool is only held for the swap.
+		void load(const std::filesystem::path& path) {
+			SnapshotReader reader(path);
+			reader.expect<Ts...>();
+
+			Registry staged(m_resource);
+			auto src = staged.pipeline<Ts...>();
+			([&]<typename U>()
+			{
+				reader.beginPool<U>();
+				src.template pool<U>().load(reader);
+			}.template operator()<Ts>(), ...);
+
+			auto dst = pipeline<Ts...>();
+			(dst.template pool<Ts>().replace(src.template pool<Ts>()), ...);
+		}
+
+		/// @brief applies a delta taken by a DeltaRecorder of a registry of the same types, the registry must be in the state
+		/// the delta was taken from, eg the baseline followed by every earlier delta in order. O(changes in the delta). 
+		/// throws std::runtime_error if the delta is not of this registry, the pools are unchanged in that case. acquires 
+		/// write access to every pool.
+		void applyDelta(std::span<const std::byte> delta) {
+			ByteReader reader(delta);
+			if (reader.read<uint64_t>() != sizeof...(Ts))
+				throw std::runtime_error("delta pool count mismatch");
+			if (((reader.read<uint64_t>() != internal::typeHash<Ts>()) || ...))
+				throw std::runtime_error("delta pool type mismatch");
+
+			auto pip = pipeline<Ts...>();
+			(pip.template pool<Ts>().loadDelta(reader), ...);
+		}
+
 	private:
 		template<typename U>
 		pool_reference_t<U> pool() {
@@ -35,12 +287,20 @@ namespace Gawr::ECS {
 		}
 
 	private:
-		storage_collection_t m_pools;
+		std::pmr::memory_resource*	m_resource;
+		storage_collection_t		m_pools;
+		mutable std::atomic<uint32_t>	m_dispatching{ 0 };	// write pipelines released but still dispatching their events
 	};
 }
 
 #include "AccessLock.h"
 #include "HandleManager.h"
 #include "Storage.h"
+#include "Relation.h"
 #include "Pipeline.h"
 #include "View.h"
+#include "Collector.h"
+#include "Index.h"
+#include "Delta.h"
+#include "BackgroundSaver.h"
+#include "StreamingLoader.h"
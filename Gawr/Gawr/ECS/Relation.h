@@ -0,0 +1,598 @@
+#pragma once
+#include "Entity.h"
+#include "AccessLock.h"
+#include "Signal.h"
+#include "PoolStats.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+namespace Gawr::ECS {
+	/// @brief names a kind of relationship between two entities in a registry, eg Relation<Targets>. filters on Relation<R>
+	/// match subjects with at least one pair. if R is not empty each pair stores an R.
+	template<typename R>
+	struct Relation { };
+
+	/// @brief (subject, object) pairs with a forward list of objects per subject and a reverse list of subjects per object.
+	/// the lists are intrusive so adding, removing and finding a pair is O(1) and enumerating either end is O(1) per pair.
+	/// events are recorded against the subject, construct on its first pair and destroy on its last.
+	/// @tparam R the relation kind
+	template<typename R>
+	class RelationStorage : public AccessLock {
+		static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+		struct Pair {
+			Entity m_subject, m_object;
+			uint32_t m_prevOut, m_nextOut;	// siblings in the subject's list
+			uint32_t m_prevIn, m_nextIn;	// siblings in the object's list
+		};
+
+		struct Node {
+			uint32_t m_outHead = npos, m_inHead = npos;
+			uint32_t m_outCount = 0, m_inCount = 0;
+		};
+
+		using get_return_t = std::conditional_t<std::is_empty_v<R>, void, R&>;
+
+	public:
+		using ForwardIterator = std::pmr::vector<Entity>::const_reverse_iterator;
+		using ReverseIterator = std::pmr::vector<Entity>::const_iterator;
+
+		/// @brief the other end of each pair in one entity's list.
+		class Range {
+		public:
+			class Iterator {
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = Entity;
+				using difference_type = std::ptrdiff_t;
+				using pointer = const Entity*;
+				using reference = Entity;
+
+				Iterator() = default;
+				Iterator(const std::pmr::vector<Pair>* pairs, uint32_t i, bool out) : m_pairs(pairs), m_curr(i), m_out(out) { }
+
+				Entity operator*() const {
+					const Pair& pair = (*m_pairs)[m_curr];
+					return m_out ? pair.m_object : pair.m_subject;
+				}
+
+				Iterator& operator++() {
+					const Pair& pair = (*m_pairs)[m_curr];
+					m_curr = m_out ? pair.m_nextOut : pair.m_nextIn;
+					return *this;
+				}
+
+				Iterator operator++(int) {
+					Iterator temp = *this;
+					++(*this);
+					return temp;
+				}
+
+				bool operator==(const Iterator& other) const { return m_curr == other.m_curr; }
+
+			private:
+				const std::pmr::vector<Pair>* m_pairs = nullptr;
+				uint32_t m_curr = npos;
+				bool m_out = true;
+			};
+
+			Range(const std::pmr::vector<Pair>& pairs, uint32_t head, uint32_t count, bool out)
+				: m_pairs(&pairs), m_head(head), m_count(count), m_out(out)
+			{ }
+
+			Iterator begin() const { return Iterator(m_pairs, m_head, m_out); }
+			Iterator end() const { return Iterator(m_pairs, npos, m_out); }
+			uint32_t size() const { return m_count; }
+			bool empty() const { return m_count == 0; }
+
+		private:
+			const std::pmr::vector<Pair>* m_pairs;
+			uint32_t m_head, m_count;
+			bool m_out;
+		};
+
+		/// @param resource allocates every array of the pool and the pair index, must outlive the pool
+		explicit RelationStorage(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			: m_data(resource), m_pairs(resource), m_nodes(resource), m_index(resource), m_sparse(8, tombstone, resource), m_packed(resource)
+		{ }
+
+		/// @return number of subjects
+		size_t size() const {
+			return m_packed.size();
+		}
+
+		size_t pairCount() const {
+			return m_pairs.size();
+		}
+
+		Entity at(size_t i) const {
+			return m_packed[i];
+		}
+
+		/// @brief true if e is the subject of any pair.
+		bool contains(Entity e) const {
+			return e < m_sparse.size() && m_sparse[e] != tombstone;
+		}
+
+		bool contains(Entity subject, Entity object) const {
+			return m_index.contains(key(subject, object));
+		}
+
+		/// @brief the objects related to subject.
+		Range targets(Entity subject) const {
+			if (subject >= m_nodes.size())
+				return Range(m_pairs, npos, 0, true);
+
+			return Range(m_pairs, m_nodes[subject].m_outHead, m_nodes[subject].m_outCount, true);
+		}
+
+		/// @brief the subjects related to object.
+		Range sources(Entity object) const {
+			if (object >= m_nodes.size())
+				return Range(m_pairs, npos, 0, false);
+
+			return Range(m_pairs, m_nodes[object].m_inHead, m_nodes[object].m_inCount, false);
+		}
+
+		R& getRelation(Entity subject, Entity object) requires (!std::is_empty_v<R>) {
+			return m_data[m_index.at(key(subject, object))];
+		}
+
+		const R& getRelation(Entity subject, Entity object) const requires (!std::is_empty_v<R>) {
+			return m_data[m_index.at(key(subject, object))];
+		}
+
+		/// @brief adds the pair, or replaces its relation if it exists.
+		template<typename ... Arg_Ts>
+		get_return_t emplace(Entity subject, Entity object, Arg_Ts&& ... args) {
+			if (auto it = m_index.find(key(subject, object)); it != m_index.end())
+			{
+				signal(Event::Update).record(subject);
+
+				if constexpr (!std::is_empty_v<R>)
+					return m_data[it->second] = R(std::forward<Arg_Ts>(args)...);
+				else
+					return;
+			}
+
+			if (m_nodes.size() <= std::max(subject, object))
+				m_nodes.resize(size_t{ std::max(subject, object) } + 1);
+
+			uint32_t i = static_cast<uint32_t>(m_pairs.size());
+			Node& out = m_nodes[subject];
+			Node& in = m_nodes[object];
+
+			// push front of both lists
+			m_pairs.push_back({ subject, object, npos, out.m_outHead, npos, in.m_inHead });
+			if (out.m_outHead != npos) m_pairs[out.m_outHead].m_prevOut = i;
+			if (in.m_inHead != npos) m_pairs[in.m_inHead].m_prevIn = i;
+			out.m_outHead = i;
+			in.m_inHead = i;
+			in.m_inCount++;
+			m_index.emplace(key(subject, object), i);
+
+			if (out.m_outCount++ == 0)
+			{
+				if (m_sparse.size() <= subject)
+					m_sparse.resize(subject + 1, tombstone);
+
+				m_sparse[subject] = m_packed.size();
+				m_packed.push_back(subject);
+				signal(Event::Construct).record(subject);
+			}
+			else
+			{
+				signal(Event::Update).record(subject);
+			}
+
+			if constexpr (!std::is_empty_v<R>)
+				return m_data.emplace_back(std::forward<Arg_Ts>(args)...);
+		}
+
+		/// @brief removes the pair if it exists.
+		void remove(Entity subject, Entity object) {
+			if (auto it = m_index.find(key(subject, object)); it != m_index.end())
+				erasePair(it->second);
+		}
+
+		/// @brief removes every pair with e at either end in O(pairs removed), used when e is destroyed.
+		void remove(Entity e) {
+			if (e >= m_nodes.size())
+				return;
+
+			while (m_nodes[e].m_outHead != npos)
+				erasePair(m_nodes[e].m_outHead);
+
+			while (m_nodes[e].m_inHead != npos)
+				erasePair(m_nodes[e].m_inHead);
+		}
+
+		/// @brief renumbers both ends of every pair after a registry compaction, pairs with an end without a new id are 
+		/// removed. relations with a remap(const EntityRemap&) member have their entity references remapped.
+		void remap(const EntityRemap& remap) {
+			for (Entity e = 0; e < m_nodes.size(); e++)
+			{
+				if (remap(e) == tombstone)
+					remove(e);
+			}
+
+			size_t size = 0;
+			for (Pair& pair : m_pairs)
+			{
+				pair.m_subject = remap(pair.m_subject);
+				pair.m_object = remap(pair.m_object);
+				size = std::max<size_t>(size, std::max(pair.m_subject, pair.m_object) + size_t{ 1 });
+			}
+
+			// list heads move with their entity, the lists themselves are by pair index so are unchanged
+			std::pmr::vector<Node> nodes(size, m_nodes.get_allocator());
+			for (Entity e = 0; e < m_nodes.size(); e++)
+			{
+				if (m_nodes[e].m_outCount > 0 || m_nodes[e].m_inCount > 0)
+					nodes[remap(e)] = m_nodes[e];
+			}
+			m_nodes = std::move(nodes);
+
+			m_index.clear();
+			m_index.reserve(m_pairs.size());
+			for (uint32_t i = 0; i < m_pairs.size(); i++)
+				m_index.emplace(key(m_pairs[i].m_subject, m_pairs[i].m_object), i);
+
+			size_t subjects = 0;
+			for (Entity& e : m_packed)
+			{
+				e = remap(e);
+				subjects = std::max<size_t>(subjects, e + 1);
+			}
+
+			m_sparse.assign(subjects, tombstone);
+			for (size_t i = 0; i < m_packed.size(); i++)
+				m_sparse[m_packed[i]] = i;
+
+			if constexpr (!std::is_empty_v<R> && requires (R& relation) { relation.remap(remap); })
+			{
+				for (R& relation : m_data)
+					relation.remap(remap);
+			}
+		}
+
+		/// @brief replaces the pool with a copy of other, reusing the pool's allocations. trivially copyable arrays are copied
+		/// in bulk. records a destroy event for each previous subject and a construct event for each copied one.
+		void copy(const RelationStorage& other) {
+			signal(Event::Destroy).record(m_packed);
+
+			m_pairs = other.m_pairs;
+			m_nodes = other.m_nodes;
+			m_index = other.m_index;
+			m_sparse = other.m_sparse;
+			m_packed = other.m_packed;
+			if constexpr (!std::is_empty_v<R>)
+				static_cast<std::pmr::vector<R>&>(m_data) = other.m_data;
+
+			signal(Event::Construct).record(m_packed);
+		}
+
+		/// @brief adds the pairs of other with both ends renumbered to their new ids, pairs with an end without a new id are
+		/// skipped. relations with a remap(const EntityRemap&) member have their entity references remapped. O(other).
+		void merge(const RelationStorage& other, const EntityRemap& remap) {
+			reserve(m_pairs.size() + other.m_pairs.size());
+
+			for (uint32_t i = 0; i < other.m_pairs.size(); i++)
+			{
+				Entity subject = remap(other.m_pairs[i].m_subject), object = remap(other.m_pairs[i].m_object);
+				if (subject == tombstone || object == tombstone)
+					continue;
+
+				if constexpr (!std::is_empty_v<R>)
+				{
+					R relation = other.m_data[i];
+					if constexpr (requires { relation.remap(remap); })
+						relation.remap(remap);
+
+					emplace(subject, object, std::move(relation));
+				}
+				else
+				{
+					emplace(subject, object);
+				}
+			}
+		}
+
+		/// @brief memory used by the pool, the pair index is estimated from its element and bucket counts. every entry of the 
+		/// subject sparse array without a pair is a tombstone.
+		PoolStats stats() const {
+			constexpr size_t indexNode = sizeof(std::pair<const uint64_t, uint32_t>) + sizeof(void*);
+
+			PoolStats stats{ .m_count = m_pairs.size(), .m_sparse = m_sparse.size(), .m_tombstones = m_sparse.size() - m_packed.size() };
+			stats.m_bytesUsed = m_pairs.size() * sizeof(Pair) + m_nodes.size() * sizeof(Node)
+				+ m_sparse.size() * sizeof(size_t) + m_packed.size() * sizeof(Entity)
+				+ m_index.size() * indexNode + m_index.bucket_count() * sizeof(void*);
+			stats.m_bytesReserved = m_pairs.capacity() * sizeof(Pair) + m_nodes.capacity() * sizeof(Node)
+				+ m_sparse.capacity() * sizeof(size_t) + m_packed.capacity() * sizeof(Entity)
+				+ m_index.size() * indexNode + m_index.bucket_count() * sizeof(void*);
+			if constexpr (!std::is_empty_v<R>)
+			{
+				stats.m_bytesUsed += m_data.size() * sizeof(R);
+				stats.m_bytesReserved += m_data.capacity() * sizeof(R);
+			}
+			return stats;
+		}
+
+		/// @brief trims the per entity arrays to the highest entity in a pair, rehashes the pair index to its size and 
+		/// releases the capacity beyond the size of each array. references to relations are invalidated.
+		void shrink() {
+			size_t nodes = m_nodes.size();
+			while (nodes > 0 && m_nodes[nodes - 1].m_outCount == 0 && m_nodes[nodes - 1].m_inCount == 0)
+				nodes--;
+
+			size_t subjects = 0;
+			for (Entity e : m_packed)
+				subjects = std::max<size_t>(subjects, e + 1);
+
+			m_nodes.resize(nodes);
+			m_sparse.resize(subjects);
+
+			m_pairs.shrink_to_fit();
+			m_nodes.shrink_to_fit();
+			m_sparse.shrink_to_fit();
+			m_packed.shrink_to_fit();
+			m_index.rehash(0);
+			if constexpr (!std::is_empty_v<R>)
+				m_data.shrink_to_fit();
+		}
+
+		/// @brief reserves room for count pairs.
+		void reserve(size_t count) {
+			m_pairs.reserve(count);
+			m_index.reserve(count);
+			if constexpr (!std::is_empty_v<R>)
+				m_data.reserve(count);
+		}
+
+		/// @brief writes the pairs, per entity lists and subject arrays to a snapshot. the pair index is rebuilt on load.
+		void save(SnapshotWriter& writer) const {
+			writer.array<Pair>(m_pairs);
+			writer.array<Node>(m_nodes);
+			writer.array<size_t>(m_sparse);
+			writer.array<Entity>(m_packed);
+			if constexpr (!std::is_empty_v<R>)
+				writer.array<R>(m_data);
+		}
+
+		/// @brief replaces the pool with one saved to a snapshot, each trivially copyable array is one bulk copy from the 
+		/// mapping and the pair index is rebuilt in O(pairs). throws std::runtime_error if the arrays are truncated or an 
+		/// index is out of range, the pool is unchanged in that case. records a destroy event for each previous subject and
+		/// a construct event for each loaded one.
+		void load(SnapshotReader& reader) {
+			// read off to the side so nothing is replaced until every array is checked
+			RelationStorage staged(m_packed.get_allocator().resource());
+			reader.read(staged.m_pairs);
+			reader.read(staged.m_nodes);
+			reader.read(staged.m_sparse);
+			reader.read(staged.m_packed);
+			if constexpr (!std::is_empty_v<R>)
+			{
+				reader.read(staged.m_data);
+				if (staged.m_data.size() != staged.m_pairs.size())
+					throw std::runtime_error("snapshot pool size mismatch");
+			}
+
+			if (!staged.validLinks() || !internal::validSparseSet(staged.m_sparse, staged.m_packed))
+				throw std::runtime_error("snapshot pool index out of range");
+
+			staged.m_index.reserve(staged.m_pairs.size());
+			for (uint32_t i = 0; i < staged.m_pairs.size(); i++)
+				staged.m_index.emplace(key(staged.m_pairs[i].m_subject, staged.m_pairs[i].m_object), i);
+
+			replace(staged);
+		}
+
+		/// @brief swaps the arrays of the pool with those of other in O(1), eg to commit a pool loaded off to the side. other
+		/// must allocate from the same resource. records a destroy event for each previous subject and a construct event 
+		/// for each new one, other records none.
+		void replace(RelationStorage& other) {
+			signal(Event::Destroy).record(m_packed);
+
+			m_pairs.swap(other.m_pairs);
+			m_nodes.swap(other.m_nodes);
+			m_index.swap(other.m_index);
+			m_sparse.swap(other.m_sparse);
+			m_packed.swap(other.m_packed);
+			if constexpr (!std::is_empty_v<R>)
+				static_cast<std::pmr::vector<R>&>(m_data).swap(other.m_data);
+
+			signal(Event::Construct).record(m_packed);
+		}
+
+		/// @brief writes the changed subjects, those without a pair as removed and the rest with every pair they are the 
+		/// subject of. every change to a pair is recorded against its subject so the subject's list is sufficient.
+		void saveDelta(ByteWriter& writer, std::span<const Entity> changed) const {
+			uint64_t present = std::count_if(changed.begin(), changed.end(), [&](Entity e) { return contains(e); });
+
+			writer.write(uint64_t{ changed.size() - present });
+			for (Entity e : changed)
+			{
+				if (!contains(e))
+					writer.write(e);
+			}
+
+			writer.write(present);
+			for (Entity subject : changed)
+			{
+				if (!contains(subject))
+					continue;
+
+				const Node& node = m_nodes[subject];
+				writer.write(subject);
+				writer.write(node.m_outCount);
+
+				// back to front, pairs are pushed to the front of the list on load so its order is kept
+				uint32_t i = node.m_outHead;
+				while (m_pairs[i].m_nextOut != npos)
+					i = m_pairs[i].m_nextOut;
+
+				for (; i != npos; i = m_pairs[i].m_prevOut)
+				{
+					writer.write(m_pairs[i].m_object);
+					if constexpr (!std::is_empty_v<R>)
+						internal::writeValue(writer, m_data[i]);
+				}
+			}
+		}
+
+		/// @brief applies a delta written by saveDelta, the pairs of each changed subject are replaced. O(pairs changed).
+		void loadDelta(ByteReader& reader) {
+			uint64_t removed = reader.read<uint64_t>();
+			for (uint64_t i = 0; i < removed; i++)
+				removeTargets(reader.read<Entity>());
+
+			uint64_t present = reader.read<uint64_t>();
+			for (uint64_t i = 0; i < present; i++)
+			{
+				Entity subject = reader.read<Entity>();
+				uint32_t count = reader.read<uint32_t>();
+				removeTargets(subject);
+
+				for (uint32_t j = 0; j < count; j++)
+				{
+					Entity object = reader.read<Entity>();
+					if constexpr (!std::is_empty_v<R>)
+						emplace(subject, object, internal::readValue<R>(reader));
+					else
+						emplace(subject, object);
+				}
+			}
+		}
+
+		/// @brief listeners are invoked with each batch of events after the pipeline that recorded them releases its access.
+		const Signal& on(Event event) const {
+			return m_signals[static_cast<size_t>(event)];
+		}
+
+		/// @brief hands off the events recorded since the last call, requires write access.
+		EventBatch takeEvents() {
+			return { m_signals[0].take(), m_signals[1].take(), m_signals[2].take() };
+		}
+
+		ForwardIterator begin() const {
+			return m_packed.rbegin();
+		}
+
+		ForwardIterator end() const {
+			return m_packed.rend();
+		}
+
+		ReverseIterator rbegin() const {
+			return m_packed.begin();
+		}
+
+		ReverseIterator rend() const {
+			return m_packed.end();
+		}
+
+	private:
+		// every pair's ends and list links, and every list head, are in range
+		bool validLinks() const {
+			auto link = [&](uint32_t i) { return i == npos || i < m_pairs.size(); };
+			for (const Pair& pair : m_pairs)
+			{
+				if (pair.m_subject >= m_nodes.size() || pair.m_object >= m_nodes.size())
+					return false;
+				if (!link(pair.m_prevOut) || !link(pair.m_nextOut) || !link(pair.m_prevIn) || !link(pair.m_nextIn))
+					return false;
+			}
+
+			return std::all_of(m_nodes.begin(), m_nodes.end(), [&](const Node& node) { return link(node.m_outHead) && link(node.m_inHead); });
+		}
+
+		static uint64_t key(Entity subject, Entity object) {
+			return (uint64_t{ subject } << 32) | object;
+		}
+
+		Signal& signal(Event event) {
+			return m_signals[static_cast<size_t>(event)];
+		}
+
+		void removeTargets(Entity subject) {
+			if (subject >= m_nodes.size())
+				return;
+
+			while (m_nodes[subject].m_outHead != npos)
+				erasePair(m_nodes[subject].m_outHead);
+		}
+
+		// swap and pop policy, the last pair is relinked at i
+		void erasePair(uint32_t i) {
+			Pair pair = m_pairs[i];
+			Node& out = m_nodes[pair.m_subject];
+			Node& in = m_nodes[pair.m_object];
+
+			if (pair.m_prevOut != npos) m_pairs[pair.m_prevOut].m_nextOut = pair.m_nextOut;
+			else out.m_outHead = pair.m_nextOut;
+			if (pair.m_nextOut != npos) m_pairs[pair.m_nextOut].m_prevOut = pair.m_prevOut;
+
+			if (pair.m_prevIn != npos) m_pairs[pair.m_prevIn].m_nextIn = pair.m_nextIn;
+			else in.m_inHead = pair.m_nextIn;
+			if (pair.m_nextIn != npos) m_pairs[pair.m_nextIn].m_prevIn = pair.m_prevIn;
+
+			in.m_inCount--;
+			m_index.erase(key(pair.m_subject, pair.m_object));
+
+			if (--out.m_outCount == 0)
+			{
+				Entity back = m_packed.back();
+				m_packed[m_sparse[pair.m_subject]] = back;
+				m_sparse[back] = m_sparse[pair.m_subject];
+				m_sparse[pair.m_subject] = tombstone;
+				m_packed.pop_back();
+				signal(Event::Destroy).record(pair.m_subject);
+			}
+			else
+			{
+				signal(Event::Update).record(pair.m_subject);
+			}
+
+			uint32_t last = static_cast<uint32_t>(m_pairs.size() - 1);
+			if (i != last)
+			{
+				Pair& moved = m_pairs[i] = m_pairs[last];
+
+				if (moved.m_prevOut != npos) m_pairs[moved.m_prevOut].m_nextOut = i;
+				else m_nodes[moved.m_subject].m_outHead = i;
+				if (moved.m_nextOut != npos) m_pairs[moved.m_nextOut].m_prevOut = i;
+
+				if (moved.m_prevIn != npos) m_pairs[moved.m_prevIn].m_nextIn = i;
+				else m_nodes[moved.m_object].m_inHead = i;
+				if (moved.m_nextIn != npos) m_pairs[moved.m_nextIn].m_prevIn = i;
+
+				m_index[key(moved.m_subject, moved.m_object)] = i;
+
+				if constexpr (!std::is_empty_v<R>)
+					m_data[i] = std::move(m_data[last]);
+			}
+
+			m_pairs.pop_back();
+			if constexpr (!std::is_empty_v<R>)
+				m_data.pop_back();
+		}
+
+		struct RelationData
+			: std::conditional_t<std::is_empty_v<R>, R/*empty type*/, std::pmr::vector<R>> {
+			RelationData(std::pmr::memory_resource* resource) requires (!std::is_empty_v<R>) : std::pmr::vector<R>(resource) { }
+			RelationData(std::pmr::memory_resource*) requires (std::is_empty_v<R>) { }
+		} m_data;
+		std::pmr::vector<Pair>						m_pairs;
+		std::pmr::vector<Node>						m_nodes;	// by entity
+		std::pmr::unordered_map<uint64_t, uint32_t>	m_index;	// pair to index in m_pairs
+		std::pmr::vector<size_t>					m_sparse;	// subjects
+		std::pmr::vector<Entity>					m_packed;
+		std::array<Signal, 3>					m_signals;
+	};
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Gawr::ECS {
+	/// @brief the part of a pass a time sliced system runs in one frame. the cursor is where the previous slice stopped, eg
+	/// an index in the system's driving pool, and is 0 at the start of each pass. the system works until the slice expires,
+	/// stores where it stopped in the cursor and returns.
+	struct Slice {
+		size_t									m_cursor = 0;
+		std::chrono::steady_clock::time_point	m_deadline;
+
+		bool expired() const {
+			return std::chrono::steady_clock::now() >= m_deadline;
+		}
+	};
+
+	/// @brief calls func(i) for each index of [slice.m_cursor, count) until the slice expires. the deadline is checked
+	/// every stride indices as reading the clock costs more than a cheap step, and at least stride indices are visited so
+	/// every slice makes progress. if the driving pool shrinks between slices the cursor is clamped to its size, entries
+	/// moved by erase during a pass may be skipped until the next pass.
+	/// @return true when the pass is complete, the cursor is reset for the next pass
+	template<typename Func_T>
+	bool sliceRange(Slice& slice, size_t count, Func_T func, size_t stride = 64) {
+		size_t i = std::min(slice.m_cursor, count);
+		while (i < count)
+		{
+			size_t end = std::min(i + stride, count);
+			for (; i < end; i++)
+				func(i);
+
+			if (i < count && slice.expired())
+			{
+				slice.m_cursor = i;
+				return false;
+			}
+		}
+
+		slice.m_cursor = 0;
+		return true;
+	}
+
+	/// @brief runs expensive but latency tolerant systems in time slices spread over frames, eg validation or index refits,
+	/// so a full pass does not spike one frame. each frame the systems run one slice each, highest priority first, until the
+	/// frame budget is spent. a system skipped for lack of budget gains a priority per frame waited so lower priorities
+	/// still run, and once it has waited maxWait frames it runs its slice even if the frame budget is spent, bounding how
+	/// far it falls behind at the cost of overrunning that frame by at most its slice budget. not thread safe, run from
+	/// the frame loop.
+	class Scheduler {
+		using steady_clock_t = std::chrono::steady_clock;
+
+	public:
+		/// @brief runs a slice of the system's pass, returns true when the pass is complete.
+		using System = std::function<bool(Slice&)>;
+
+		struct Stats {
+			std::string					m_name;
+			uint64_t					m_slices = 0;
+			uint64_t					m_passes = 0;			// passes completed
+			uint64_t					m_skipped = 0;			// frames skipped for lack of budget
+			uint64_t					m_forced = 0;			// slices run over the frame budget by starvation protection
+			uint64_t					m_framesPerPass = 0;	// frames spanned by the latest completed pass
+			steady_clock_t::duration	m_maxSlice{};
+		};
+
+		/// @param budget longest slice, the system stops at its first deadline check past it
+		/// @param priority systems with higher priority run first within a frame
+		/// @param maxWait frames the system may be skipped before it runs regardless of the frame budget
+		/// @return the id of the system, eg for stats
+		size_t add(std::string name, System system, steady_clock_t::duration budget, int priority = 0, uint32_t maxWait = 8) {
+			Entry& entry = m_systems.emplace_back();
+			entry.m_stats.m_name = std::move(name);
+			entry.m_system = std::move(system);
+			entry.m_budget = budget;
+			entry.m_priority = priority;
+			entry.m_maxWait = maxWait;
+			entry.m_passBegin = m_frame;
+			return m_systems.size() - 1;
+		}
+
+		/// @brief runs one frame, a slice of each system that fits in budget.
+		void run(steady_clock_t::duration budget) {
+			steady_clock_t::time_point begin = steady_clock_t::now();
+
+			// aged priority, a waiting system overtakes one more priority level each frame
+			m_order.resize(m_systems.size());
+			for (size_t i = 0; i < m_order.size(); i++)
+				m_order[i] = i;
+
+			std::ranges::stable_sort(m_order, std::greater{}, [&](size_t i) {
+				return int64_t{ m_systems[i].m_priority } + m_systems[i].m_waited;
+			});
+
+			for (size_t i : m_order)
+			{
+				Entry& entry = m_systems[i];
+				steady_clock_t::time_point start = steady_clock_t::now();
+				steady_clock_t::duration remaining = budget - (start - begin);
+
+				bool starving = entry.m_waited >= entry.m_maxWait;
+				if (remaining <= steady_clock_t::duration::zero() && !starving)
+				{
+					entry.m_waited++;
+					entry.m_stats.m_skipped++;
+					continue;
+				}
+
+				Slice slice{ entry.m_cursor, start + (starving ? entry.m_budget : std::min(entry.m_budget, remaining)) };
+				bool done = entry.m_system(slice);
+
+				Stats& stats = entry.m_stats;
+				stats.m_slices++;
+				stats.m_forced += remaining <= steady_clock_t::duration::zero();
+				stats.m_maxSlice = std::max(stats.m_maxSlice, steady_clock_t::now() - start);
+
+				entry.m_waited = 0;
+				entry.m_cursor = done ? 0 : slice.m_cursor;
+				if (done)
+				{
+					stats.m_passes++;
+					stats.m_framesPerPass = m_frame - entry.m_passBegin + 1;
+					entry.m_passBegin = m_frame + 1;
+				}
+			}
+
+			m_frame++;
+		}
+
+		const Stats& stats(size_t id) const {
+			return m_systems.at(id).m_stats;
+		}
+
+		size_t size() const {
+			return m_systems.size();
+		}
+
+	private:
+		struct Entry {
+			System						m_system;
+			steady_clock_t::duration	m_budget{};
+			int							m_priority = 0;
+			uint32_t					m_maxWait = 0;
+			uint32_t					m_waited = 0;	// frames skipped since the last slice
+			size_t						m_cursor = 0;
+			uint64_t					m_passBegin = 0;
+			Stats						m_stats;
+		};
+
+		std::vector<Entry>	m_systems;
+		std::vector<size_t>	m_order;	// scratch, reused between frames
+		uint64_t			m_frame = 0;
+	};
+}
@@ -0,0 +1,188 @@
+#pragma once
+#include "Entity.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Gawr::ECS {
+	/// @brief the kind of change recorded against an entity in a pool
+	enum class Event { Construct, Update, Destroy };
+
+	/// @brief the listeners of a single event type in a single pool. events are recorded while the pool is write locked and
+	/// handed off as one batch when the pipeline holding the lock is released. listeners are called once per batch.
+	class Signal {
+	public:
+		using Listener = std::function<void(std::span<const Entity>)>;
+
+	private:
+		// a connected listener. dispatch calls it under its mutex, so disconnect waits for a call in flight on another thread
+		// and the listener is never called once disconnect returns. recursive so a listener may disconnect itself
+		struct Connection {
+			size_t					m_handle;
+			Listener				m_listener;
+			std::recursive_mutex	m_mtx;
+			bool					m_connected = true;
+
+			Connection(size_t handle, Listener listener) : m_handle(handle), m_listener(std::move(listener)) { }
+		};
+
+		using listener_collection_t = std::vector<std::shared_ptr<Connection>>;
+
+	public:
+		/// @brief the events recorded by a pool since the last batch, and the listeners connected when it was taken. the
+		/// event buffer is handed back to the signal when the batch is destroyed, so recording reuses its capacity.
+		class Batch {
+			friend class Signal;
+		public:
+			Batch() = default;
+			Batch(Batch&& other) noexcept
+				: m_events(std::move(other.m_events)), m_listeners(std::move(other.m_listeners)), m_signal(std::exchange(other.m_signal, nullptr))
+			{ }
+
+			Batch& operator=(Batch&&) = delete;
+
+			~Batch() {
+				if (m_signal)
+					m_signal->recycle(std::move(m_events));
+			}
+
+			void dispatch() const {
+				if (m_events.empty() || !m_listeners)
+					return;
+
+				for (auto& connection : *m_listeners)
+				{
+					std::lock_guard guard(connection->m_mtx);
+					if (connection->m_connected)
+						connection->m_listener(m_events);
+				}
+			}
+
+		private:
+			std::vector<Entity>							 m_events;
+			std::shared_ptr<const listener_collection_t> m_listeners;
+			const Signal*								 m_signal = nullptr;	// to return the buffer to
+		};
+
+		Signal() = default;
+		Signal(const Signal&) = delete;
+		Signal& operator=(const Signal&) = delete;
+
+		/// @brief connecting does not modify the pool so is allowed through a read only pool.
+		/// @return a handle used to disconnect the listener
+		size_t connect(Listener listener) const {
+			std::lock_guard guard(m_mtx);
+
+			// copy on write, batches already taken keep the listeners they were taken with
+			auto listeners = m_listeners ?
+				std::make_shared<listener_collection_t>(*m_listeners) :
+				std::make_shared<listener_collection_t>();
+
+			listeners->push_back(std::make_shared<Connection>(m_next, std::move(listener)));
+			m_listeners = std::move(listeners);
+			m_connected.store(true, std::memory_order_relaxed);
+			return m_next++;
+		}
+
+		/// @brief blocks until a call to the listener in flight on another thread returns, eg from a batch taken before the
+		/// disconnect, the listener is not called after.
+		void disconnect(size_t handle) const {
+			std::shared_ptr<Connection> connection;
+			{
+				std::lock_guard guard(m_mtx);
+				if (!m_listeners)
+					return;
+
+				auto listeners = std::make_shared<listener_collection_t>(*m_listeners);
+				auto it = std::ranges::find_if(*listeners, [=](auto& connection) { return connection->m_handle == handle; });
+				if (it == listeners->end())
+					return;
+
+				connection = std::move(*it);
+				listeners->erase(it);
+
+				if (listeners->empty())
+				{
+					m_listeners.reset();
+					m_connected.store(false, std::memory_order_relaxed);
+				}
+				else
+				{
+					m_listeners = std::move(listeners);
+				}
+			}
+
+			// batches taken earlier still hold the connection
+			std::lock_guard guard(connection->m_mtx);
+			connection->m_connected = false;
+		}
+
+		/// @brief requires write access to the pool. events are only recorded while a listener is connected.
+		void record(Entity e) {
+			if (m_connected.load(std::memory_order_relaxed))
+				m_events.push_back(e);
+		}
+
+		/// @brief records an event for each entity, requires write access to the pool.
+		void record(std::span<const Entity> entities) {
+			if (m_connected.load(std::memory_order_relaxed))
+				m_events.insert(m_events.end(), entities.begin(), entities.end());
+		}
+
+		/// @brief requires write access to the pool. hands off the recorded events in O(1), recording continues into a 
+		/// buffer returned by an earlier batch so a steady stream of events stops allocating.
+		Batch take() {
+			Batch batch;
+			if (m_events.empty())
+				return batch;
+
+			std::swap(batch.m_events, m_events);
+			batch.m_signal = this;
+
+			std::lock_guard guard(m_mtx);
+			batch.m_listeners = m_listeners;
+			if (!m_spare.empty())
+			{
+				std::swap(m_events, m_spare.back());
+				m_spare.pop_back();
+			}
+			return batch;
+		}
+
+	private:
+		// a batch's buffer once dispatched. batches from several pipelines may be in flight, the few kept cover the usual
+		// overlap without holding on to every buffer of a burst
+		void recycle(std::vector<Entity> events) const {
+			constexpr size_t maxSpare = 4;
+
+			events.clear();
+			std::lock_guard guard(m_mtx);
+			if (m_spare.size() < maxSpare)
+				m_spare.push_back(std::move(events));
+		}
+
+		std::vector<Entity>										m_events;
+		mutable std::mutex										m_mtx;
+		mutable std::vector<std::vector<Entity>>				m_spare;	// cleared buffers of dispatched batches
+		mutable std::shared_ptr<const listener_collection_t>	m_listeners;
+		mutable std::atomic<bool>								m_connected{ false };
+		mutable size_t											m_next{ 0 };
+	};
+
+	/// @brief the batches taken from a single pool, one for each event type.
+	struct EventBatch {
+		std::array<Signal::Batch, 3> m_batches;
+
+		void dispatch() const {
+			for (auto& batch : m_batches)
+				batch.dispatch();
+		}
+	};
+}
@@ -0,0 +1,357 @@
+#pragma once
+#include "Entity.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace Gawr::ECS {
+	/// @brief appends the bytes of a serialized component.
+	class ByteWriter {
+	public:
+		explicit ByteWriter(std::vector<std::byte>& bytes) : m_bytes(bytes) { }
+
+		void write(const void* data, size_t size) {
+			// resize and copy rather than a ranged insert, which gcc 12 misreads as an overflow
+			size_t offset = m_bytes.size();
+			m_bytes.resize(offset + size);
+			std::memcpy(m_bytes.data() + offset, data, size);
+		}
+
+		template<typename T>
+		void write(const T& value) requires std::is_trivially_copyable_v<T> {
+			write(&value, sizeof(T));
+		}
+
+	private:
+		std::vector<std::byte>& m_bytes;
+	};
+
+	/// @brief consumes the bytes of a serialized component.
+	class ByteReader {
+	public:
+		explicit ByteReader(std::span<const std::byte> bytes) : m_bytes(bytes) { }
+
+		void read(void* data, size_t size) {
+			if (size > m_bytes.size())
+				throw std::runtime_error("snapshot section truncated");
+
+			std::memcpy(data, m_bytes.data(), size);
+			m_bytes = m_bytes.subspan(size);
+		}
+
+		size_t remaining() const {
+			return m_bytes.size();
+		}
+
+		template<typename T>
+		T read() requires std::is_trivially_copyable_v<T> {
+			std::array<std::byte, sizeof(T)> bytes;	// T need not be default constructible
+			read(bytes.data(), sizeof(T));
+			return std::bit_cast<T>(bytes);
+		}
+
+	private:
+		std::span<const std::byte> m_bytes;
+	};
+
+	/// @brief specialise with static void save(ByteWriter&, const T&) and static T load(ByteReader&) to snapshot a type that
+	/// is not trivially copyable, eg a component holding a string. trivially copyable types are written as they are.
+	template<typename T>
+	struct Serializer;
+
+	namespace internal {
+		template<typename T>
+		concept Serializable = requires (ByteWriter& writer, ByteReader& reader, const T& value) {
+			Serializer<T>::save(writer, value);
+			{ Serializer<T>::load(reader) } -> std::convertible_to<T>;
+		};
+
+		// identifies a pool within a build, snapshots are not portable between compilers
+		template<typename T>
+		uint64_t typeHash() {
+			uint64_t hash = 14695981039346656037ull;	// fnv-1a
+			for (char c : std::string_view(typeid(T).name()))
+				hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+			return hash;
+		}
+
+		/// @brief writes a single value, trivially copyable types as they are and others through their Serializer.
+		template<typename T>
+		void writeValue(ByteWriter& writer, const T& value) {
+			if constexpr (std::is_trivially_copyable_v<T>)
+				writer.write(value);
+			else if constexpr (Serializable<T>)
+				Serializer<T>::save(writer, value);
+			else
+				static_assert(sizeof(T) == 0, "type is not trivially copyable and has no Serializer specialisation");
+		}
+
+		template<typename T>
+		T readValue(ByteReader& reader) {
+			if constexpr (std::is_trivially_copyable_v<T>)
+				return reader.read<T>();
+			else if constexpr (Serializable<T>)
+				return Serializer<T>::load(reader);
+			else
+				static_assert(sizeof(T) == 0, "type is not trivially copyable and has no Serializer specialisation");
+		}
+
+		constexpr char		snapshotMagic[8] = { 'G', 'A', 'W', 'R', 'S', 'N', 'A', 'P' };
+		constexpr uint32_t	snapshotVersion = 1;
+		constexpr size_t	sectionAlignment = 64;	// at least the alignment of any component, and a cache line
+		constexpr size_t	maxSections = 6;
+		constexpr size_t	maxScalars = 2;
+
+		struct Section {
+			uint64_t m_offset;
+			uint64_t m_size;	// bytes
+		};
+
+		struct PoolHeader {
+			uint64_t m_type;
+			uint32_t m_sections;
+			uint32_t m_scalars;
+			uint64_t m_scalar[maxScalars];
+			Section  m_section[maxSections];
+		};
+
+		struct FileHeader {
+			char	 m_magic[8];
+			uint32_t m_version;
+			uint32_t m_pools;
+		};
+
+		constexpr size_t alignSection(size_t offset) {
+			return (offset + sectionAlignment - 1) & ~(sectionAlignment - 1);
+		}
+
+		/// @brief true if every packed entity indexes its own slot and no other sparse entry is set, so lookups through a
+		/// sparse set read from a snapshot stay in bounds. O(sparse + packed).
+		inline bool validSparseSet(std::span<const size_t> sparse, std::span<const Entity> packed) {
+			size_t set = std::count_if(sparse.begin(), sparse.end(), [](size_t index) { return index != tombstone; });
+			if (set != packed.size())
+				return false;
+
+			for (size_t i = 0; i < packed.size(); i++)
+			{
+				if (packed[i] >= sparse.size() || sparse[packed[i]] != i)
+					return false;
+			}
+			return true;
+		}
+	}
+
+	/// @brief writes a snapshot file, a table of pool headers followed by each pool's arrays as sections aligned to 64 bytes.
+	/// trivially copyable arrays are written as they are in memory so they can be read straight from a mapping.
+	class SnapshotWriter {
+	public:
+		SnapshotWriter(const std::filesystem::path& path, size_t poolCount)
+			: m_file(path, std::ios::binary | std::ios::trunc), m_pools(poolCount)
+		{
+			if (!m_file)
+				throw std::runtime_error("cannot create snapshot file");
+
+			m_offset = internal::alignSection(sizeof(internal::FileHeader) + poolCount * sizeof(internal::PoolHeader));
+			m_file.seekp(m_offset);
+		}
+
+		template<typename T>
+		void beginPool() {
+			if (m_current + 1 == m_pools.size())
+				throw std::runtime_error("snapshot has more pools than declared");
+
+			m_current++;
+			m_pools[m_current] = { .m_type = internal::typeHash<T>(), .m_sections = 0, .m_scalars = 0, .m_scalar = { }, .m_section = { } };
+		}
+
+		/// @brief writes an array as a section, types that are not trivially copyable are written through their Serializer.
+		template<typename T>
+		void array(std::span<const T> values) {
+			if constexpr (std::is_trivially_copyable_v<T>)
+			{
+				section(values.data(), values.size_bytes());
+			}
+			else if constexpr (internal::Serializable<T>)
+			{
+				m_bytes.clear();
+				ByteWriter writer(m_bytes);
+				writer.write(uint64_t{ values.size() });
+				for (const T& value : values)
+					Serializer<T>::save(writer, value);
+
+				section(m_bytes.data(), m_bytes.size());
+			}
+			else
+			{
+				static_assert(sizeof(T) == 0, "type is not trivially copyable and has no Serializer specialisation");
+			}
+		}
+
+		void scalar(uint64_t value) {
+			internal::PoolHeader& pool = current();
+			if (pool.m_scalars == internal::maxScalars)
+				throw std::runtime_error("snapshot pool has too many scalars");
+
+			pool.m_scalar[pool.m_scalars++] = value;
+		}
+
+		/// @brief writes the pool table, the file is complete once finish returns.
+		void finish() {
+			internal::FileHeader header{ .m_magic = { }, .m_version = internal::snapshotVersion, .m_pools = static_cast<uint32_t>(m_pools.size()) };
+			std::copy(std::begin(internal::snapshotMagic), std::end(internal::snapshotMagic), header.m_magic);
+
+			m_file.seekp(0);
+			m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			m_file.write(reinterpret_cast<const char*>(m_pools.data()), m_pools.size() * sizeof(internal::PoolHeader));
+			m_file.flush();
+
+			if (!m_file)
+				throw std::runtime_error("cannot write snapshot file");
+		}
+
+	private:
+		internal::PoolHeader& current() {
+			if (m_current >= m_pools.size())
+				throw std::runtime_error("snapshot written outside a pool");
+			return m_pools[m_current];
+		}
+
+		void section(const void* data, size_t size) {
+			internal::PoolHeader& pool = current();
+			if (pool.m_sections == internal::maxSections)
+				throw std::runtime_error("snapshot pool has too many sections");
+
+			pool.m_section[pool.m_sections++] = { m_offset, size };
+
+			static constexpr char padding[internal::sectionAlignment] = { };
+			size_t end = internal::alignSection(m_offset + size);
+
+			m_file.write(static_cast<const char*>(data), size);
+			m_file.write(padding, end - m_offset - size);
+			m_offset = end;
+		}
+
+		std::ofstream						m_file;
+		std::vector<internal::PoolHeader>	m_pools;
+		std::vector<std::byte>				m_bytes;	// scratch for serialized sections
+		size_t								m_current = size_t(-1);
+		size_t								m_offset;
+	};
+
+	/// @brief reads a snapshot file through a mapping. trivially copyable arrays are viewed in place, so reading costs the
+	/// page in of the sections read and one bulk copy into the pool.
+	class SnapshotReader {
+	public:
+		explicit SnapshotReader(const std::filesystem::path& path) : m_file(path) {
+			std::span<const std::byte> bytes = m_file.bytes();
+			if (bytes.size() < sizeof(internal::FileHeader))
+				throw std::runtime_error("not a snapshot file");
+
+			std::memcpy(&m_header, bytes.data(), sizeof(m_header));
+			if (!std::equal(std::begin(internal::snapshotMagic), std::end(internal::snapshotMagic), m_header.m_magic))
+				throw std::runtime_error("not a snapshot file");
+			if (m_header.m_version != internal::snapshotVersion)
+				throw std::runtime_error("unsupported snapshot version");
+			if (bytes.size() < sizeof(internal::FileHeader) + m_header.m_pools * sizeof(internal::PoolHeader))
+				throw std::runtime_error("snapshot file truncated");
+
+			m_pools = reinterpret_cast<const internal::PoolHeader*>(bytes.data() + sizeof(internal::FileHeader));
+		}
+
+		/// @brief throws unless the snapshot holds exactly pools of Ts in order, checked before any pool is read.
+		template<typename ... Ts>
+		void expect() const {
+			if (m_header.m_pools != sizeof...(Ts))
+				throw std::runtime_error("snapshot pool count mismatch");
+
+			size_t i = 0;
+			if (((m_pools[i++].m_type != internal::typeHash<Ts>()) || ...))
+				throw std::runtime_error("snapshot pool type mismatch");
+		}
+
+		template<typename T>
+		void beginPool() {
+			if (m_next >= m_header.m_pools || m_pools[m_next].m_type != internal::typeHash<T>())
+				throw std::runtime_error("snapshot pool type mismatch");
+
+			m_current = &m_pools[m_next++];
+			m_section = 0;
+			m_scalar = 0;
+		}
+
+		/// @brief the next section viewed in place, valid while the reader is alive.
+		template<typename T>
+		std::span<const T> array() requires std::is_trivially_copyable_v<T> {
+			std::span<const std::byte> bytes = section();
+			if (bytes.size() % sizeof(T) != 0)
+				throw std::runtime_error("snapshot section size mismatch");
+
+			return { reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T) };
+		}
+
+		/// @brief replaces out with the next section, one bulk copy if trivially copyable, otherwise through its Serializer.
+		template<typename T>
+		void read(std::pmr::vector<T>& out) {
+			if constexpr (std::is_trivially_copyable_v<T>)
+			{
+				std::span<const T> values = array<T>();
+				out.assign(values.begin(), values.end());
+			}
+			else if constexpr (internal::Serializable<T>)
+			{
+				ByteReader reader(section());
+				uint64_t count = reader.read<uint64_t>();
+
+				// a corrupt count must not reserve more than the section could hold
+				out.clear();
+				out.reserve(std::min<uint64_t>(count, reader.remaining()));
+				for (uint64_t i = 0; i < count; i++)
+					out.push_back(Serializer<T>::load(reader));
+			}
+			else
+			{
+				static_assert(sizeof(T) == 0, "type is not trivially copyable and has no Serializer specialisation");
+			}
+		}
+
+		uint64_t scalar() {
+			if (m_scalar >= std::min<size_t>(m_current->m_scalars, internal::maxScalars))
+				throw std::runtime_error("snapshot pool truncated");
+			return m_current->m_scalar[m_scalar++];
+		}
+
+	private:
+		std::span<const std::byte> section() {
+			if (m_section >= std::min<size_t>(m_current->m_sections, internal::maxSections))
+				throw std::runtime_error("snapshot pool truncated");
+
+			internal::Section section = m_current->m_section[m_section++];
+			if (section.m_offset > m_file.size() || section.m_size > m_file.size() - section.m_offset)
+				throw std::runtime_error("snapshot file truncated");
+
+			return m_file.bytes().subspan(section.m_offset, section.m_size);
+		}
+
+		MappedFile						m_file;
+		internal::FileHeader			m_header;
+		const internal::PoolHeader*		m_pools = nullptr;
+		const internal::PoolHeader*		m_current = nullptr;
+		size_t							m_next = 0;
+		size_t							m_section = 0;
+		size_t							m_scalar = 0;
+	};
+}
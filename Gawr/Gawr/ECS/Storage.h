@@ -1,7 +1,16 @@
 #pragma once
 #include "Entity.h"
 #include "AccessLock.h"
-
+#include "Signal.h"
+#include "Parallel.h"
+#include "PoolStats.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <vector>
 #include <shared_mutex>
 
@@ -11,15 +20,19 @@ namespace Gawr::ECS {
 	template<typename T>
 	class Storage : public AccessLock {
 		template<typename ... Arg_Ts>
-		using reorder_func_t = void(*)(std::vector<Entity>::iterator, std::vector<Entity>::iterator, Arg_Ts&&...);
+		using reorder_func_t = void(*)(std::pmr::vector<Entity>::iterator, std::pmr::vector<Entity>::iterator, Arg_Ts&&...);
 
 		using get_return_t = std::conditional_t<std::is_empty_v<T>, void, T&>;
 
 	public:
-		using ForwardIterator = std::vector<Entity>::const_reverse_iterator;
-		using ReverseIterator = std::vector<Entity>::const_iterator;
+		using PackedIterator = std::pmr::vector<Entity>::iterator;
+		using ForwardIterator = std::pmr::vector<Entity>::const_reverse_iterator;
+		using ReverseIterator = std::pmr::vector<Entity>::const_iterator;
 
-		Storage() : m_sparse(8, tombstone) { }
+		/// @param resource allocates every array of the pool, must outlive the pool
+		explicit Storage(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			: m_components(resource), m_sparse(8, tombstone, resource), m_packed(resource) 
+		{ }
 
 		size_t size() const {
 			return m_packed.size();
@@ -49,6 +62,8 @@ namespace Gawr::ECS {
 		get_return_t emplace(Entity e, Arg_Ts&& ... args) {
 			if (contains(e))
 			{
+				signal(Event::Update).record(e);
+
 				if constexpr (!std::is_empty_v<T>)
 					return m_components[m_sparse[e]] = T(std::forward<Arg_Ts>(args)...);
 				else
@@ -62,6 +77,8 @@ namespace Gawr::ECS {
 				m_sparse[e] = m_packed.size();
 				m_packed.push_back(e);
 
+				signal(Event::Construct).record(e);
+
 				if constexpr (!std::is_empty_v<T>) 
 					return m_components.emplace_back(args...);
 				else 
@@ -81,14 +98,16 @@ namespace Gawr::ECS {
 		void erase(size_t i) {
 			// swap and pop policy
 			
+			signal(Event::Destroy).record(m_packed[i]);
+
 			if constexpr (!std::is_empty_v<T>)
 			{
 				m_components[i] = m_components.back();
 				m_components.pop_back();
 			}
 
-			m_sparse[m_packed[i]] = tombstone;
 			m_sparse[m_packed.back()] = i;
+			m_sparse[m_packed[i]] = tombstone;	// after back, in case i is back
 
 			m_packed[i] = m_packed.back();
 			m_packed.pop_back();
@@ -98,37 +117,316 @@ namespace Gawr::ECS {
 			erase(index(e));
 		}
 
+		/// @brief records an update event for a component modified in place through getComponent.
+		void update(Entity e) {
+			signal(Event::Update).record(e);
+		}
+
+		/// @brief records an update event for each entity, eg after a system writes a batch of components in place.
+		void update(std::span<const Entity> entities) {
+			signal(Event::Update).record(entities);
+		}
+
+		/// @brief renumbers the entities after a registry compaction, entities without a new id are erased. components with 
+		/// a remap(const EntityRemap&) member have their entity references remapped. the sparse array shrinks to the highest
+		/// id.
+		void remap(const EntityRemap& remap) {
+			for (size_t i = m_packed.size(); i-- > 0;)
+			{
+				if (remap(m_packed[i]) == tombstone)
+					erase(i);
+			}
+
+			size_t size = 0;
+			for (Entity& e : m_packed)
+			{
+				e = remap(e);
+				size = std::max<size_t>(size, e + 1);
+			}
+
+			m_sparse.assign(size, tombstone);
+			for (size_t i = 0; i < m_packed.size(); i++)
+				m_sparse[m_packed[i]] = i;
+
+			if constexpr (!std::is_empty_v<T> && requires (T& component) { component.remap(remap); })
+			{
+				for (T& component : m_components)
+					component.remap(remap);
+			}
+		}
+
+		/// @brief replaces the pool with a copy of other, reusing the pool's allocations. trivially copyable arrays are copied
+		/// in bulk. records a destroy event for each previous entity and a construct event for each copied one.
+		void copy(const Storage& other) {
+			signal(Event::Destroy).record(m_packed);
+
+			m_sparse = other.m_sparse;
+			m_packed = other.m_packed;
+			if constexpr (!std::is_empty_v<T>)
+				static_cast<std::pmr::vector<T>&>(m_components) = other.m_components;
+
+			signal(Event::Construct).record(m_packed);
+		}
+
+		/// @brief adds the components of other under the new ids of their entities, entities without a new id are skipped
+		/// and components of entities already in the pool are replaced. components with a remap(const EntityRemap&) member 
+		/// have their entity references remapped. the arrays grow once, O(other).
+		void merge(const Storage& other, const EntityRemap& remap) {
+			size_t first = m_packed.size();
+			size_t size = m_sparse.size();
+			for (Entity e : other.m_packed)
+			{
+				if (remap(e) != tombstone)
+					size = std::max<size_t>(size, remap(e) + size_t{ 1 });
+			}
+
+			m_sparse.resize(size, tombstone);
+			m_packed.reserve(first + other.m_packed.size());
+			if constexpr (!std::is_empty_v<T>)
+				m_components.reserve(first + other.m_packed.size());
+
+			for (size_t i = 0; i < other.m_packed.size(); i++)
+			{
+				Entity e = remap(other.m_packed[i]);
+				if (e == tombstone)
+					continue;
+
+				if (contains(e))
+				{
+					signal(Event::Update).record(e);
+					if constexpr (!std::is_empty_v<T>)
+						m_components[m_sparse[e]] = other.m_components[i];
+				}
+				else
+				{
+					m_sparse[e] = m_packed.size();
+					m_packed.push_back(e);
+					if constexpr (!std::is_empty_v<T>)
+						m_components.push_back(other.m_components[i]);
+				}
+
+				if constexpr (!std::is_empty_v<T> && requires (T& component) { component.remap(remap); })
+					m_components[m_sparse[e]].remap(remap);
+			}
+
+			signal(Event::Construct).record(std::span<const Entity>(m_packed).subspan(first));
+		}
+
+		/// @brief memory used by the pool, every entry of the sparse array without a component is a tombstone.
+		PoolStats stats() const {
+			PoolStats stats{ .m_count = m_packed.size(), .m_sparse = m_sparse.size(), .m_tombstones = m_sparse.size() - m_packed.size() };
+			stats.m_bytesUsed = m_sparse.size() * sizeof(size_t) + m_packed.size() * sizeof(Entity);
+			stats.m_bytesReserved = m_sparse.capacity() * sizeof(size_t) + m_packed.capacity() * sizeof(Entity);
+			if constexpr (!std::is_empty_v<T>)
+			{
+				stats.m_bytesUsed += m_components.size() * sizeof(T);
+				stats.m_bytesReserved += m_components.capacity() * sizeof(T);
+			}
+			return stats;
+		}
+
+		/// @brief trims the sparse array to the highest id in the pool and releases the capacity beyond the size of each 
+		/// array. components are reallocated so references to them are invalidated.
+		void shrink() {
+			size_t size = 0;
+			for (Entity e : m_packed)
+				size = std::max<size_t>(size, e + 1);
+
+			m_sparse.resize(size);
+			m_sparse.shrink_to_fit();
+			m_packed.shrink_to_fit();
+			if constexpr (!std::is_empty_v<T>)
+				m_components.shrink_to_fit();
+		}
+
+		/// @brief reserves room for count components, and for ids below maxEntity without growing the sparse array.
+		void reserve(size_t count, Entity maxEntity = 0) {
+			m_packed.reserve(count);
+			if constexpr (!std::is_empty_v<T>)
+				m_components.reserve(count);
+
+			if (m_sparse.size() < maxEntity)
+				m_sparse.resize(maxEntity, tombstone);
+		}
+
+		/// @brief writes the sparse, packed and component arrays to a snapshot.
+		void save(SnapshotWriter& writer) const {
+			writer.array<size_t>(m_sparse);
+			writer.array<Entity>(m_packed);
+			if constexpr (!std::is_empty_v<T>)
+				writer.array<T>(m_components);
+		}
+
+		/// @brief replaces the pool with one saved to a snapshot, each trivially copyable array is one bulk copy from the 
+		/// mapping. throws std::runtime_error if the arrays are truncated or an index is out of range, the pool is unchanged
+		/// in that case. records a destroy event for each previous entity and a construct event for each loaded one.
+		void load(SnapshotReader& reader) {
+			// read off to the side so nothing is replaced until every array is checked
+			Storage staged(m_packed.get_allocator().resource());
+			reader.read(staged.m_sparse);
+			reader.read(staged.m_packed);
+			if constexpr (!std::is_empty_v<T>)
+			{
+				reader.read(staged.m_components);
+				if (staged.m_components.size() != staged.m_packed.size())
+					throw std::runtime_error("snapshot pool size mismatch");
+			}
+
+			if (!internal::validSparseSet(staged.m_sparse, staged.m_packed))
+				throw std::runtime_error("snapshot pool index out of range");
+
+			replace(staged);
+		}
+
+		/// @brief swaps the arrays of the pool with those of other in O(1), eg to commit a pool loaded off to the side. other
+		/// must allocate from the same resource. records a destroy event for each previous entity and a construct event for
+		/// each new one, other records none.
+		void replace(Storage& other) {
+			signal(Event::Destroy).record(m_packed);
+
+			m_sparse.swap(other.m_sparse);
+			m_packed.swap(other.m_packed);
+			if constexpr (!std::is_empty_v<T>)
+				static_cast<std::pmr::vector<T>&>(m_components).swap(other.m_components);
+
+			signal(Event::Construct).record(m_packed);
+		}
+
+		/// @brief writes the changed entities, those no longer in the pool as removed and the rest with their component.
+		void saveDelta(ByteWriter& writer, std::span<const Entity> changed) const {
+			uint64_t present = std::count_if(changed.begin(), changed.end(), [&](Entity e) { return contains(e); });
+
+			writer.write(uint64_t{ changed.size() - present });
+			for (Entity e : changed)
+			{
+				if (!contains(e))
+					writer.write(e);
+			}
+
+			writer.write(present);
+			for (Entity e : changed)
+			{
+				if (!contains(e))
+					continue;
+
+				writer.write(e);
+				if constexpr (!std::is_empty_v<T>)
+					internal::writeValue(writer, getComponent(e));
+			}
+		}
+
+		/// @brief applies a delta written by saveDelta, removed entities are erased and the others emplaced. O(changed), 
+		/// iteration order may differ from the pool the delta was taken from.
+		void loadDelta(ByteReader& reader) {
+			uint64_t removed = reader.read<uint64_t>();
+			for (uint64_t i = 0; i < removed; i++)
+			{
+				Entity e = reader.read<Entity>();
+				if (contains(e))
+					remove(e);
+			}
+
+			uint64_t present = reader.read<uint64_t>();
+			for (uint64_t i = 0; i < present; i++)
+			{
+				Entity e = reader.read<Entity>();
+				if constexpr (!std::is_empty_v<T>)
+					emplace(e, internal::readValue<T>(reader));
+				else
+					emplace(e);
+			}
+		}
+
+		/// @brief listeners are invoked with each batch of events after the pipeline that recorded them releases its access.
+		const Signal& on(Event event) const {
+			return m_signals[static_cast<size_t>(event)];
+		}
+
+		/// @brief hands off the events recorded since the last call, requires write access.
+		EventBatch takeEvents() {
+			return { m_signals[0].take(), m_signals[1].take(), m_signals[2].take() };
+		}
+
 		template<typename ... Arg_Ts>
 		void reorder(reorder_func_t<Arg_Ts...> func, Arg_Ts&& ... args) {
 			// when a pair is swapped it will only move the entity so this could break
 			// fine as long as the component is retrieved through entity and not index
 
 			func(m_packed.begin(), m_packed.end(), std::forward<Arg_Ts>(args)...);
+			permute();
+		}
 
-			if constexpr (std::is_empty_v<T>)
+		/// @brief orders the pool so iteration visits components in ascending order of cmp, equal components keep their
+		/// relative order. O(n log n) comparisons.
+		template<typename Cmp_T>
+		void sort(Cmp_T cmp) requires (!std::is_empty_v<T>) {
+			std::vector<Entity> order(m_packed.rbegin(), m_packed.rend());	// iteration order
+			std::stable_sort(order.begin(), order.end(), [&](Entity lhs, Entity rhs) { 
+				return cmp(m_components[m_sparse[lhs]], m_components[m_sparse[rhs]]); 
+			});
+
+			std::copy(order.rbegin(), order.rend(), m_packed.begin());
+			permute();
+		}
+
+		/// @brief orders the pool so iteration visits components in ascending order of keyFn(component), equal keys keep 
+		/// their relative order. integer and bool keys are radix sorted in parallel in O(n * sizeof key), other keys are 
+		/// compared.
+		template<typename KeyFn_T>
+		void sortByKey(KeyFn_T keyFn) requires (!std::is_empty_v<T>) {
+			using key_t = std::remove_cvref_t<std::invoke_result_t<KeyFn_T, const T&>>;
+
+			if constexpr (std::is_integral_v<key_t>)
 			{
-				for (size_t i = 0; i < m_packed.size(); i++)				// iterate through the packed to update the lookup in the sparse array
-					m_sparse[m_packed[i]] = i;
+				using unsigned_t = typename internal::RadixKey<key_t>::type;
+				constexpr unsigned_t flip = std::is_signed_v<key_t> ? unsigned_t{ 1 } << (sizeof(key_t) * 8 - 1) : 0;	// orders negatives first
+
+				size_t count = m_packed.size();
+				size_t chunks = internal::chunkCount(count);
+
+				// in iteration order
+				std::vector<unsigned_t> keys(count);
+				std::vector<Entity> order(count);
+				internal::parallelChunks(count, chunks, [&](size_t, size_t begin, size_t end) {
+					for (size_t i = begin; i < end; i++)
+					{
+						order[i] = m_packed[count - 1 - i];
+						keys[i] = static_cast<unsigned_t>(keyFn(m_components[count - 1 - i])) ^ flip;
+					}
+				});
+
+				internal::radixSort(keys, order, chunks);
+
+				std::copy(order.rbegin(), order.rend(), m_packed.begin());
+				permute();
 			}
 			else
 			{
-				for (size_t pos = 0; pos < m_packed.size(); pos++)			// iterate through starting index
-				{
-					size_t curr = m_sparse[m_packed[pos]];					// index that entity at pos used to be stored at
-
-					while (curr != pos)										// if curr == pos, component is in the correct index
-					{
-						size_t next = m_sparse[m_packed[curr]];				// index that entity at curr used to be stored at
+				sort([&](const T& lhs, const T& rhs) { return keyFn(lhs) < keyFn(rhs); });
+			}
+		}
 
-						m_sparse[m_packed[curr]] = curr;					// set sparse lookup for curr to the new index
-						std::swap(m_components[curr], m_components[next]);	// move component at curr to correct position
+		/// @brief orders the entities shared with other first in other's order, followed by the remaining entities in their
+		/// current order. pools sorted as the same pool are iterated in step, so joined iteration reads both sequentially.
+		template<typename Pool_T>
+		void sortAs(const Pool_T& other) {
+			std::vector<Entity> order;
+			order.reserve(m_packed.size());
 
-						curr = next;										// set curr to next
-					}
+			for (size_t i = 0; i < other.size(); i++)
+			{
+				if (contains(other.at(i)))
+					order.push_back(other.at(i));
+			}
 
-					m_sparse[m_packed[curr]] = pos;							// when I remove this it breaks -> must be important.
-				}
+			for (Entity e : m_packed)
+			{
+				if (!other.contains(e))
+					order.push_back(e);
 			}
+
+			std::copy(order.begin(), order.end(), m_packed.begin());
+			permute();
 		}
 
 		ForwardIterator begin() const {
@@ -148,10 +446,50 @@ namespace Gawr::ECS {
 		}
 
 	private:
+		Signal& signal(Event event) {
+			return m_signals[static_cast<size_t>(event)];
+		}
+
+		// moves each component to the new index of its entity, m_packed holds the new order and m_sparse the old. components
+		// are gathered in parallel into scratch then moved back, as the destinations are distinct no synchronisation is needed.
+		void permute() {
+			size_t count = m_packed.size();
+			size_t chunks = internal::chunkCount(count);
+
+			if constexpr (!std::is_empty_v<T>)
+			{
+				std::allocator<T> allocator;
+				T* scratch = allocator.allocate(count);
+
+				internal::parallelChunks(count, chunks, [&](size_t, size_t begin, size_t end) {
+					for (size_t i = begin; i < end; i++)
+						std::construct_at(scratch + i, std::move(m_components[m_sparse[m_packed[i]]]));
+				});
+
+				internal::parallelChunks(count, chunks, [&](size_t, size_t begin, size_t end) {
+					for (size_t i = begin; i < end; i++)
+					{
+						m_components[i] = std::move(scratch[i]);
+						std::destroy_at(scratch + i);
+					}
+				});
+
+				allocator.deallocate(scratch, count);
+			}
+
+			internal::parallelChunks(count, chunks, [&](size_t, size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+					m_sparse[m_packed[i]] = i;
+			});
+		}
+
 		struct ComponentStorage
-			: std::conditional_t<std::is_empty_v<T>, T/*empty type*/, std::vector<T>> {
+			: std::conditional_t<std::is_empty_v<T>, T/*empty type*/, std::pmr::vector<T>> {
+			ComponentStorage(std::pmr::memory_resource* resource) requires (!std::is_empty_v<T>) : std::pmr::vector<T>(resource) { }
+			ComponentStorage(std::pmr::memory_resource*) requires (std::is_empty_v<T>) { }
 		} m_components;
-		std::vector<size_t>		m_sparse;
-		std::vector<Entity>		m_packed;
+		std::pmr::vector<size_t>	m_sparse;
+		std::pmr::vector<Entity>	m_packed;
+		std::array<Signal, 3>	m_signals;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,181 @@
+#pragma once
+#include "Registry.h"
+#include "Memory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Gawr::ECS {
+	/// @brief streams chunks of a scene, snapshot files saved by Registry::save, into a live registry without blocking
+	/// its systems. worker threads map and decode each chunk into a private staging registry, backed by an arena released
+	/// with it. commit merges the staged chunks into the live registry at a sync point, eg between frames, until a time
+	/// budget is spent. the loader must not outlive the live registry.
+	template<typename ... Ts>
+	class StreamingLoader {
+		using steady_clock_t = std::chrono::steady_clock;
+
+	public:
+		/// @brief the outcome of a chunk, returned by the commit that merged it.
+		struct Chunk {
+			size_t						m_id;		// returned by request
+			std::filesystem::path		m_path;
+			EntityRemap					m_remap;	// chunk entities to live entities, empty if the load failed
+			std::exception_ptr			m_error;	// set if the chunk could not be loaded, eg a missing file
+
+			// latency of each stage
+			steady_clock_t::duration	m_queued;	// request to a worker starting the load
+			steady_clock_t::duration	m_decode;	// mapping and decoding into the staging registry
+			steady_clock_t::duration	m_staged;	// decoded to the commit that merged it
+			steady_clock_t::duration	m_merge;	// merging into the live registry
+
+			steady_clock_t::duration latency() const {
+				return m_queued + m_decode + m_staged + m_merge;
+			}
+		};
+
+		/// @param workers threads decoding chunks, decoding is mostly bound by paging in the file so a few suffice
+		explicit StreamingLoader(Registry<Ts...>& live, size_t workers = 2) : m_live(live) {
+			for (size_t i = 0; i < std::max<size_t>(workers, 1); i++)
+				m_workers.emplace_back([this](std::stop_token stop) { run(stop); });
+		}
+
+		/// @brief abandons the requests not yet started, waits for the chunks being decoded and discards every staged chunk.
+		~StreamingLoader() {
+			{
+				std::lock_guard guard(m_mtx);
+				m_requests.clear();
+			}
+
+			for (std::jthread& worker : m_workers)
+				worker.request_stop();
+			m_workers.clear();
+		}
+
+		StreamingLoader(const StreamingLoader&) = delete;
+		StreamingLoader& operator=(const StreamingLoader&) = delete;
+
+		/// @brief queues a chunk to be decoded in the background, chunks are started in the order they are requested and 
+		/// staged in the order they finish decoding.
+		/// @return an id identifying the chunk in the commit that merges it
+		size_t request(const std::filesystem::path& path) {
+			std::unique_ptr<Staging> staging = std::make_unique<Staging>();
+			staging->m_chunk.m_path = path;
+			staging->m_requested = steady_clock_t::now();
+
+			size_t id;
+			{
+				std::lock_guard guard(m_mtx);
+				id = staging->m_chunk.m_id = m_next++;
+				m_requests.push_back(std::move(staging));
+			}
+			m_wake.notify_one();
+			return id;
+		}
+
+		/// @brief merges staged chunks into the live registry, in the order they were staged, until budget is spent. at least
+		/// one chunk is merged if any is staged, so a single chunk larger than the budget overruns it by its merge time, size
+		/// chunks so their merge fits. acquires write access to every pool of the live registry for each merge.
+		/// @return the chunks merged or failed in this commit
+		std::vector<Chunk> commit(steady_clock_t::duration budget) {
+			steady_clock_t::time_point begin = steady_clock_t::now();
+
+			std::vector<Chunk> committed;
+			while (committed.empty() || steady_clock_t::now() - begin < budget)
+			{
+				std::unique_ptr<Staging> staging;
+				{
+					std::lock_guard guard(m_mtx);
+					if (m_staged.empty())
+						break;
+
+					staging = std::move(m_staged.front());
+					m_staged.pop_front();
+				}
+
+				Chunk& chunk = staging->m_chunk;
+				steady_clock_t::time_point merging = steady_clock_t::now();
+				chunk.m_staged = merging - staging->m_decoded;
+
+				if (!chunk.m_error)
+					chunk.m_remap = m_live.merge(*staging->m_registry);
+
+				chunk.m_merge = steady_clock_t::now() - merging;
+				committed.push_back(std::move(chunk));
+			}
+
+			return committed;
+		}
+
+		/// @brief chunks requested but not yet committed.
+		size_t pending() const {
+			std::lock_guard guard(m_mtx);
+			return m_requests.size() + m_decoding + m_staged.size();
+		}
+
+	private:
+		struct Staging {
+			MonotonicArena						m_arena;	// everything the staging registry allocates, released at once
+			std::unique_ptr<Registry<Ts...>>	m_registry;
+			Chunk								m_chunk{};
+			steady_clock_t::time_point			m_requested, m_decoded;
+		};
+
+		void run(std::stop_token stop) {
+			while (true)
+			{
+				std::unique_ptr<Staging> staging;
+				{
+					std::unique_lock lock(m_mtx);
+					// a request queued while stopping is abandoned rather than decoded
+					if (!m_wake.wait(lock, stop, [&]() { return !m_requests.empty(); }) || stop.stop_requested())
+						return;
+
+					staging = std::move(m_requests.front());
+					m_requests.pop_front();
+					m_decoding++;
+				}
+
+				Chunk& chunk = staging->m_chunk;
+				steady_clock_t::time_point decoding = steady_clock_t::now();
+				chunk.m_queued = decoding - staging->m_requested;
+
+				try
+				{
+					staging->m_registry = std::make_unique<Registry<Ts...>>(&staging->m_arena);
+					staging->m_registry->load(chunk.m_path);
+				}
+				catch (...)
+				{
+					chunk.m_error = std::current_exception();
+					staging->m_registry.reset();
+				}
+
+				staging->m_decoded = steady_clock_t::now();
+				chunk.m_decode = staging->m_decoded - decoding;
+
+				std::lock_guard guard(m_mtx);
+				m_staged.push_back(std::move(staging));
+				m_decoding--;
+			}
+		}
+
+		Registry<Ts...>&						m_live;
+
+		mutable std::mutex						m_mtx;
+		std::condition_variable_any				m_wake;
+		std::deque<std::unique_ptr<Staging>>	m_requests;
+		std::deque<std::unique_ptr<Staging>>	m_staged;
+		size_t									m_decoding = 0;
+		size_t									m_next = 0;
+
+		std::vector<std::jthread>				m_workers;	// last, joined before the members they use are destroyed
+	};
+}
@@ -20,7 +20,7 @@ namespace Gawr::ECS {
 				while (m_current != m_end && !valid()) ++m_current;
 			}
 
-			Select_T::template Return_T operator*() {
+			typename Select_T::Return_T operator*() {
 				return Select_T::retrieve(m_pipeline, *m_current);
 			}
 
@@ -52,33 +52,76 @@ namespace Gawr::ECS {
 			pool_iterator_t m_current;
 			pool_iterator_t m_end;
 		};
-		using ForwardIterator = Iterator<typename Pool<typename From_T::type>::ForwardIterator>;
-		using ReverseIterator = Iterator<typename Pool<typename From_T::type>::ReverseIterator>;
+	private:
+		template<typename Source_T, typename = void>
+		struct SourceIterators {
+			using Forward = typename Pool<typename Source_T::type>::ForwardIterator;
+			using Reverse = typename Pool<typename Source_T::type>::ReverseIterator;
+		};
+
+		template<typename Void_T>
+		struct SourceIterators<FromEntities, Void_T> {
+			using Forward = std::span<const Entity>::iterator;
+			using Reverse = std::span<const Entity>::reverse_iterator;
+		};
+
+	public:
+		using ForwardIterator = Iterator<typename SourceIterators<From_T>::Forward>;
+		using ReverseIterator = Iterator<typename SourceIterators<From_T>::Reverse>;
 
-		View(Pipeline<Pip_Ts...>& pip) : m_pipeline(pip) { }
+		View(Pipeline<Pip_Ts...>& pip, From_T from = { }) : m_pipeline(pip), m_from(from) { }
 
 		auto begin() const {
-			auto& pool = m_pipeline.pool<typename From_T::type>();
-			return ForwardIterator(m_pipeline, pool.begin(), pool.end());
+			if constexpr (std::is_same_v<From_T, FromEntities>)
+			{
+				return ForwardIterator(m_pipeline, m_from.m_entities.begin(), m_from.m_entities.end());
+			}
+			else
+			{
+				auto& pool = m_pipeline.pool<typename From_T::type>();
+				return ForwardIterator(m_pipeline, pool.begin(), pool.end());
+			}
 		}
 
 		auto end() const {
-			auto& pool = m_pipeline.pool<typename From_T::type>();
-			return ForwardIterator(m_pipeline, pool.end(), pool.end());
+			if constexpr (std::is_same_v<From_T, FromEntities>)
+			{
+				return ForwardIterator(m_pipeline, m_from.m_entities.end(), m_from.m_entities.end());
+			}
+			else
+			{
+				auto& pool = m_pipeline.pool<typename From_T::type>();
+				return ForwardIterator(m_pipeline, pool.end(), pool.end());
+			}
 		}
 
 		auto rbegin() const {
-			auto& pool = m_pipeline.pool<typename From_T::type>();
-			return ReverseIterator(m_pipeline, pool.rbegin(), pool.rend());
+			if constexpr (std::is_same_v<From_T, FromEntities>)
+			{
+				return ReverseIterator(m_pipeline, m_from.m_entities.rbegin(), m_from.m_entities.rend());
+			}
+			else
+			{
+				auto& pool = m_pipeline.pool<typename From_T::type>();
+				return ReverseIterator(m_pipeline, pool.rbegin(), pool.rend());
+			}
 		}
 
 		auto rend() const {
-			auto& pool = m_pipeline.pool<typename From_T::type>();
-			return ReverseIterator(m_pipeline, pool.rend(), pool.rend());
+			if constexpr (std::is_same_v<From_T, FromEntities>)
+			{
+				return ReverseIterator(m_pipeline, m_from.m_entities.rend(), m_from.m_entities.rend());
+			}
+			else
+			{
+				auto& pool = m_pipeline.pool<typename From_T::type>();
+				return ReverseIterator(m_pipeline, pool.rend(), pool.rend());
+			}
 		}
 
 
 	private:
 		Pipeline<Pip_Ts...>& m_pipeline;
+		From_T m_from;
 	};
 }
@@ -0,0 +1,224 @@
+#pragma once
+#include "Components/Extraction.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Render {
+	/// @brief world matrices of current blended towards previous by alpha, matched by entity. instances new in current are
+	/// not blended. rows are blended linearly, close to a slerp for the small rotations of one tick. O(n) when the two
+	/// packets hold the same entities in the same order, otherwise previous is indexed by entity first.
+	/// @param alpha 0 is previous, 1 is current
+	inline void interpolate(const FramePacket& previous, const FramePacket& current, float alpha, std::vector<Transform::Affine>& out) {
+		using namespace Gawr::ECS;
+
+		auto blend = [&](const Transform::Affine& a, const Transform::Affine& b) {
+			Transform::Affine result;
+			for (int row = 0; row < 3; row++)
+				result.m_rows[row] = a.m_rows[row] + (b.m_rows[row] - a.m_rows[row]) * alpha;
+			return result;
+		};
+
+		out.resize(current.size());
+		if (previous.m_entities == current.m_entities)
+		{
+			for (size_t i = 0; i < current.size(); i++)
+				out[i] = blend(previous.m_world[i], current.m_world[i]);
+			return;
+		}
+
+		Entity maxEntity = 0;
+		for (Entity e : previous.m_entities)
+			maxEntity = std::max(maxEntity, e);
+
+		std::vector<size_t> index(previous.size() ? size_t{ maxEntity } + 1 : 0, tombstone);
+		for (size_t i = 0; i < previous.size(); i++)
+			index[previous.m_entities[i]] = i;
+
+		for (size_t i = 0; i < current.size(); i++)
+		{
+			Entity e = current.m_entities[i];
+			if (e < index.size() && index[e] != tombstone)
+				out[i] = blend(previous.m_world[index[e]], current.m_world[i]);
+			else
+				out[i] = current.m_world[i];
+		}
+	}
+}
+
+/// @brief ticks a scene at a fixed rate on its own thread, independent of the display rate. after each tick the renderables
+/// are extracted into a timestamped snapshot. the render loop acquires the latest two snapshots and interpolates between
+/// them at a render time one tick in the past, so motion is smooth at any display rate and lags by at most two ticks. the
+/// snapshots are frame packets in a five slot FramePacketBuffer so the simulation never waits on the render loop: the two
+/// latest, the two held by the render loop and the one being written.
+class Simulation {
+	using steady_clock_t = std::chrono::steady_clock;
+	static constexpr size_t maxCatchUp = 5;	// ticks run back to back after a stall before the schedule is reset
+	static constexpr size_t budgetWindow = 1024;	// latest tick times kept for the percentiles of the budget report
+
+public:
+	/// @param tick advances the scene by dt seconds, called on the simulation thread
+	using Tick = std::function<void(Scene&, double dt)>;
+
+	/// @brief the snapshots to draw and how far to blend between them.
+	struct Frame {
+		const Render::FramePacket*	m_previous = nullptr;
+		const Render::FramePacket*	m_current = nullptr;	// nullptr until two ticks have run
+		float						m_alpha = 1.0f;			// 0 draws previous, 1 draws current
+
+		explicit operator bool() const {
+			return m_current != nullptr;
+		}
+	};
+
+	/// @brief how much of the tick period the ticks have used, the tick and the extraction after it.
+	struct Budget {
+		uint64_t					m_ticks = 0;
+		uint64_t					m_overruns = 0;	// ticks that took longer than the period
+		uint64_t					m_dropped = 0;	// ticks skipped to recover from a stall
+		steady_clock_t::duration	m_period{};
+		steady_clock_t::duration	m_mean{};
+		steady_clock_t::duration	m_max{};
+		steady_clock_t::duration	m_p50{};		// percentiles over the latest budgetWindow ticks
+		steady_clock_t::duration	m_p99{};
+
+		/// @brief mean tick time as a fraction of the period, above 1 the simulation cannot keep its rate.
+		double usage() const {
+			return m_period.count() ? double(m_mean.count()) / double(m_period.count()) : 0.0;
+		}
+	};
+
+	/// @param rate ticks per second
+	Simulation(Scene& scene, double rate, Tick tick)
+		: m_scene(scene), m_tick(std::move(tick)), m_period(std::chrono::duration_cast<steady_clock_t::duration>(std::chrono::duration<double>(1.0 / rate)))
+	{
+		m_thread = std::jthread([this](std::stop_token stop) { run(stop); });
+	}
+
+	Simulation(const Simulation&) = delete;
+	Simulation& operator=(const Simulation&) = delete;
+
+	/// @brief the latest two snapshots, read only until release. never blocks on the simulation.
+	Frame acquire() {
+		auto [previous, current] = m_packets.acquireLatest();
+		if (!previous)
+		{
+			m_packets.release();
+			return { };
+		}
+
+		// render one tick behind so there is always a later snapshot to blend towards
+		steady_clock_t::time_point renderTime = steady_clock_t::now() - m_period;
+		float alpha = std::chrono::duration<float>(renderTime - previous->m_time) / std::chrono::duration<float>(current->m_time - previous->m_time);
+
+		return { previous, current, std::clamp(alpha, 0.0f, 1.0f) };
+	}
+
+	void release() {
+		m_packets.release();
+	}
+
+	/// @brief ticks run since construction.
+	uint64_t ticks() const {
+		std::lock_guard guard(m_mtx);
+		return m_ticks;
+	}
+
+	double rate() const {
+		return 1.0 / std::chrono::duration<double>(m_period).count();
+	}
+
+	/// @brief tick times since construction, O(budgetWindow).
+	Budget budget() const {
+		Budget budget;
+		steady_clock_t::duration total;
+		std::vector<steady_clock_t::duration> window;
+		{
+			std::lock_guard guard(m_mtx);
+			budget = m_budget;
+			total = m_total;
+			window = m_window;
+		}
+
+		budget.m_period = m_period;
+		if (budget.m_ticks)
+			budget.m_mean = total / budget.m_ticks;
+
+		auto percentile = [&](double p) {
+			auto nth = window.begin() + size_t(p * double(window.size() - 1));
+			std::nth_element(window.begin(), nth, window.end());
+			return *nth;
+		};
+
+		if (!window.empty())
+		{
+			budget.m_p50 = percentile(0.5);
+			budget.m_p99 = percentile(0.99);
+		}
+		return budget;
+	}
+
+private:
+	void run(std::stop_token stop) {
+		double dt = std::chrono::duration<double>(m_period).count();
+		steady_clock_t::time_point next = steady_clock_t::now();
+		uint64_t dropped = 0;
+
+		while (!stop.stop_requested())
+		{
+			std::this_thread::sleep_until(next);
+
+			// after a stall, eg a debugger break, drop the missed ticks rather than running them all back to back
+			steady_clock_t::time_point begin = steady_clock_t::now();
+			if (begin - next > m_period * maxCatchUp)
+			{
+				dropped += (begin - next) / m_period;
+				next = begin;
+			}
+
+			m_tick(m_scene, dt);
+
+			// the scheduled time of the tick, not when it ran, so steps are even
+			Render::FramePacket& packet = m_packets.beginWrite();
+			packet.m_time = next;
+			extractRenderables(m_scene, packet, m_ticks + 1);
+			m_packets.publish();
+
+			steady_clock_t::duration elapsed = steady_clock_t::now() - begin;
+			{
+				std::lock_guard guard(m_mtx);
+				m_ticks++;
+
+				m_budget.m_ticks = m_ticks;
+				m_budget.m_overruns += elapsed > m_period;
+				m_budget.m_dropped = dropped;
+				m_budget.m_max = std::max(m_budget.m_max, elapsed);
+				m_total += elapsed;
+
+				if (m_window.size() < budgetWindow)
+					m_window.push_back(elapsed);
+				else
+					m_window[m_ticks % budgetWindow] = elapsed;
+			}
+
+			next += m_period;
+		}
+	}
+
+	Scene&						m_scene;
+	Tick						m_tick;
+	steady_clock_t::duration	m_period;
+
+	Render::FramePacketBuffer<5, 2>	m_packets;
+	mutable std::mutex			m_mtx;
+	uint64_t					m_ticks = 0;
+	Budget						m_budget;
+	steady_clock_t::duration	m_total{};
+	std::vector<steady_clock_t::duration>	m_window;	// ring of the latest tick times
+
+	std::jthread				m_thread;	// last, joined before the members it uses are destroyed
+};
@@ -909,6 +909,9 @@ void Application::run()
 		currentFrame = ++currentFrame % m_frames.size();
 		currentImage = acquireImage(m_frames[currentFrame]);
 
+		// the fence wait in acquireImage means nothing from the last use of this frame is still being read
+		m_frameAllocator.beginFrame(currentFrame);
+
 		recordCommand(m_frames[currentFrame], currentImage);
 		submitCommand(m_frames[currentFrame], currentImage);
 	}
@@ -7,6 +7,7 @@
 #include <glfw3native.h>
 #include <vulkan/vk_enum_string_helper.h>
 #include <glm/glm.hpp>
+#include "Gawr/ECS/Memory.h"
 
 #include <string>
 #include <vector>
@@ -45,6 +46,9 @@ public:
 	~Application();
 
 	void run();
+
+	/// @brief scratch memory for systems run during the current frame, valid until the frame is next in flight.
+	std::pmr::memory_resource* frameResource(size_t worker = 0) { return m_frameAllocator.resource(worker); }
 private:
 	// context
 	/* create vulkan instance*/
@@ -128,6 +132,9 @@ private:
 	};
 	std::array<Frame, 2> m_frames;
 
+	// transient system data, an arena per frame in flight so it is reset only once its fence has been waited on
+	Gawr::ECS::FrameAllocator m_frameAllocator{ std::tuple_size_v<decltype(m_frames)> };
+
 	// shader program
 	VkPipelineLayout	m_pipelineLayout;
 	VkPipeline			m_graphicsPipeline;
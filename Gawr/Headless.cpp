@@ -0,0 +1,165 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "Gawr/Components/Hierarchy.h"
+#include "Gawr/Simulation.h"
+#include "Benchmark.h"
+
+// runs the scene systems at a fixed tick rate with no window or graphics device, eg on a dedicated server or in CI, and
+// reports how much of the tick budget they used. built by CMakeLists.txt, the Visual Studio project builds main.cpp.
+namespace {
+	struct Options {
+		double			m_rate = 60.0;
+		double			m_seconds = 5.0;
+		size_t			m_roots = 64;
+		size_t			m_depth = 2;
+		size_t			m_branching = 16;
+		TransformMode	m_mode = TransformMode::Matrix;
+		double			m_maxUsage = 0.0;	// percent of the budget, 0 to not check
+		double			m_slice = 0.5;		// milliseconds per tick for the time sliced systems
+		bool			m_benchmark = false;
+	};
+
+	void usage(std::ostream& out) {
+		out << "usage: GawrHeadless [options]\n"
+			"\t--rate <hz>          ticks per second (60)\n"
+			"\t--seconds <s>        run time (5)\n"
+			"\t--roots <n>          hierarchies in the scene (64)\n"
+			"\t--depth <n>          levels below each root (2)\n"
+			"\t--branching <n>      children per entity (16)\n"
+			"\t--mode <mode>        world transform update: matrix, parallel or hybrid (matrix)\n"
+			"\t--slice <ms>         time per tick for the time sliced systems, eg hierarchy validation (0.5)\n"
+			"\t--max-usage <pct>    fail if the mean tick uses more of the budget, eg to gate CI\n"
+			"\t--benchmark          run the transform and extraction benchmarks and exit\n";
+	}
+
+	bool parse(int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			if (arg == "--benchmark")
+			{
+				options.m_benchmark = true;
+				continue;
+			}
+
+			if (i + 1 == argc)
+				return false;
+
+			std::string value = argv[++i];
+			try
+			{
+				if (arg == "--rate")			options.m_rate = std::stod(value);
+				else if (arg == "--seconds")	options.m_seconds = std::stod(value);
+				else if (arg == "--roots")		options.m_roots = std::stoul(value);
+				else if (arg == "--depth")		options.m_depth = std::stoul(value);
+				else if (arg == "--branching")	options.m_branching = std::stoul(value);
+				else if (arg == "--slice")		options.m_slice = std::stod(value);
+				else if (arg == "--max-usage")	options.m_maxUsage = std::stod(value);
+				else if (arg == "--mode" && value == "matrix")		options.m_mode = TransformMode::Matrix;
+				else if (arg == "--mode" && value == "parallel")	options.m_mode = TransformMode::MatrixParallel;
+				else if (arg == "--mode" && value == "hybrid")		options.m_mode = TransformMode::Hybrid;
+				else return false;
+			}
+			catch (const std::exception&)
+			{
+				return false;
+			}
+		}
+		return options.m_rate > 0.0 && options.m_seconds >= 0.0;
+	}
+
+	double milliseconds(std::chrono::steady_clock::duration duration) {
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace Gawr::ECS;
+	using namespace Transform;
+
+	Options options;
+	if (!parse(argc, argv, options))
+	{
+		usage(std::cerr);
+		return EXIT_FAILURE;
+	}
+
+	if (options.m_benchmark)
+	{
+		Benchmark::transforms(std::cout);
+		Benchmark::extraction(std::cout);
+		return EXIT_SUCCESS;
+	}
+
+	Scene scene;
+	std::vector<Entity> roots = Benchmark::internal::build(scene, options.m_roots, options.m_depth, options.m_branching);
+	updateHierarchy(scene);
+
+	size_t entities = scene.pipeline<const Entity>().pool<const Entity>().stats().m_count;
+	std::cout << "headless: " << entities << " entities at " << options.m_rate << " Hz for " << options.m_seconds << " s\n";
+
+	// scratch for the systems of a tick, as in the application frame loop
+	FrameAllocator frames(2, 1);
+	uint64_t tick = 0;
+	double angle = 0.0;
+
+	// latency tolerant systems run a slice per tick rather than a full pass
+	auto sliceBudget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(options.m_slice));
+	Scheduler scheduler;
+	scheduler.add("hierarchy validation", [&](Slice& slice) { return validateHierarchy(scene, slice, frames.resource()); }, sliceBudget);
+
+	Simulation::Budget budget;
+	{
+		// every root spins, so every entity's world transform is updated each tick
+		Simulation simulation(scene, options.m_rate, [&](Scene& scene, double dt)
+		{
+			frames.beginFrame(tick++);
+			angle += dt;
+
+			{
+				auto pipeline = scene.pipeline<Rotation, UpdateTag>();
+				auto& rotationPool = pipeline.pool<Rotation>();
+				auto& updatePool = pipeline.pool<UpdateTag>();
+				for (Entity root : roots)
+				{
+					rotationPool.getComponent(root).m_rotation = glm::angleAxis(float(angle), glm::vec3(0.0f, 1.0f, 0.0f));
+					if (!updatePool.contains(root))
+						updatePool.emplace(root);
+				}
+			}
+
+			scheduler.run(sliceBudget);
+			updateWorldTransform(scene, options.m_mode, frames.resource());
+		});
+
+		std::this_thread::sleep_for(std::chrono::duration<double>(options.m_seconds));
+		budget = simulation.budget();
+	}
+
+	// the simulation thread has stopped, the scheduler is only read from here
+	std::cout << "ticks: " << budget.m_ticks << " (" << budget.m_dropped << " dropped)\n"
+		<< "budget: " << milliseconds(budget.m_period) << " ms per tick\n"
+		<< "tick: mean " << milliseconds(budget.m_mean) << " ms, p50 " << milliseconds(budget.m_p50)
+		<< " ms, p99 " << milliseconds(budget.m_p99) << " ms, max " << milliseconds(budget.m_max) << " ms\n"
+		<< "usage: " << budget.usage() * 100.0 << "% of budget, " << budget.m_overruns << " ticks over budget\n";
+
+	for (size_t id = 0; id < scheduler.size(); id++)
+	{
+		const Scheduler::Stats& stats = scheduler.stats(id);
+		std::cout << stats.m_name << ": " << stats.m_passes << " passes, " << stats.m_framesPerPass << " ticks per pass, max slice "
+			<< milliseconds(stats.m_maxSlice) << " ms\n";
+	}
+
+	if (options.m_maxUsage > 0.0 && budget.usage() * 100.0 > options.m_maxUsage)
+	{
+		std::cerr << "mean tick exceeds " << options.m_maxUsage << "% of budget\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
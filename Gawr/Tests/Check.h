@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdlib>
+#include <iostream>
+
+// minimal checks for the test executables run by ctest, a failed check prints its location and exits with failure
+#define GAWR_CHECK(condition)																			\
+	do {																								\
+		if (!(condition))																				\
+		{																								\
+			std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n";				\
+			std::exit(EXIT_FAILURE);																	\
+		}																								\
+	} while (false)
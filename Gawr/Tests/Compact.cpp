@@ -0,0 +1,113 @@
+#include <vector>
+
+#include "Gawr/ECS/Registry.h"
+#include "Check.h"
+
+// after compact the live entities are a dense prefix, every component and relation is reachable through its entity's new
+// id and entity references held in components are remapped, references to destroyed entities become tombstone
+namespace {
+	using namespace Gawr::ECS;
+
+	struct Tag { };
+	struct Health { float m_value; };
+	struct Follows { float m_weight; };
+
+	struct Target {
+		Entity m_target;
+
+		void remap(const EntityRemap& remap) {
+			m_target = remap(m_target);
+		}
+	};
+
+	using World = Registry<Entity, Tag, Health, Target, Relation<Follows>>;
+
+	struct Expected {
+		Entity	m_entity;
+		bool	m_tag;
+		float	m_health;
+		Entity	m_target;	// old id
+		Entity	m_follows;	// old id, tombstone for none
+	};
+}
+
+int main()
+{
+	constexpr size_t count = 300;
+
+	World world;
+	std::vector<Entity> entities;
+	{
+		auto pipeline = world.pipeline<Entity, Tag, Health, Target, Relation<Follows>>();
+		for (size_t i = 0; i < count; i++)
+			entities.push_back(pipeline.pool<Entity>().create());
+
+		for (size_t i = 0; i < count; i++)
+		{
+			Entity e = entities[i];
+			if (i % 2 == 0)
+				pipeline.pool<Tag>().emplace(e);
+			pipeline.pool<Health>().emplace(e, float(i) * 0.5f);
+			pipeline.pool<Target>().emplace(e, entities[(i * 7 + 3) % count]);
+			if (i % 5 != 0)
+				pipeline.pool<Relation<Follows>>().emplace(e, entities[(i + 11) % count], float(i));
+		}
+	}
+
+	// every third entity, so survivors reference destroyed entities and ids have holes to close
+	std::vector<Entity> destroyed;
+	for (size_t i = 0; i < count; i += 3)
+		destroyed.push_back(entities[i]);
+	world.destroy(destroyed);
+
+	std::vector<Expected> expected;
+	{
+		auto pipeline = world.pipeline<const Entity, const Tag, const Health, const Target, const Relation<Follows>>();
+		for (size_t i = 0; i < count; i++)
+		{
+			Entity e = entities[i];
+			if (!pipeline.pool<const Entity>().valid(e))
+				continue;
+
+			auto& follows = pipeline.pool<const Relation<Follows>>();
+			Entity object = (i + 11) % count;
+			expected.push_back({ e, pipeline.pool<const Tag>().contains(e), pipeline.pool<const Health>().getComponent(e).m_value,
+				pipeline.pool<const Target>().getComponent(e).m_target, follows.contains(e, entities[object]) ? entities[object] : tombstone });
+		}
+	}
+
+	auto compaction = world.compact();
+	const EntityRemap& remap = compaction.m_remap;
+	GAWR_CHECK(compaction.m_memoryAfter <= compaction.m_memoryBefore);
+
+	for (Entity e : destroyed)
+		GAWR_CHECK(remap(e) == tombstone);
+
+	auto pipeline = world.pipeline<const Entity, const Tag, const Health, const Target, const Relation<Follows>>();
+	auto& handles = pipeline.pool<const Entity>();
+	auto& tags = pipeline.pool<const Tag>();
+	auto& healths = pipeline.pool<const Health>();
+	auto& targets = pipeline.pool<const Target>();
+	auto& follows = pipeline.pool<const Relation<Follows>>();
+
+	// dense prefix
+	GAWR_CHECK(handles.stats().m_count == expected.size());
+	GAWR_CHECK(handles.stats().m_sparse == expected.size());
+	GAWR_CHECK(healths.size() == expected.size() && targets.size() == expected.size());
+
+	for (const Expected& old : expected)
+	{
+		Entity e = remap(old.m_entity);
+		GAWR_CHECK(e < expected.size() && handles.valid(e));
+		GAWR_CHECK(tags.contains(e) == old.m_tag);
+		GAWR_CHECK(healths.contains(e) && healths.getComponent(e).m_value == old.m_health);
+		GAWR_CHECK(targets.contains(e) && targets.getComponent(e).m_target == remap(old.m_target));
+
+		if (old.m_follows != tombstone)
+			GAWR_CHECK(follows.contains(e, remap(old.m_follows)) && follows.getRelation(e, remap(old.m_follows)).m_weight == float(old.m_entity));
+		else
+			GAWR_CHECK(follows.targets(e).empty());
+	}
+
+	return EXIT_SUCCESS;
+}
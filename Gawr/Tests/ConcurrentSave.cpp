@@ -0,0 +1,93 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "Gawr/ECS/Registry.h"
+#include "Check.h"
+
+// a save taken while another thread writes must be a consistent cut. the writer releases its pools before dispatching its
+// events, a delta taken in between would hold an entity's new link to a target the delta does not create
+namespace {
+	using namespace Gawr::ECS;
+
+	struct Link { Entity m_target; };
+
+	using Linked = Registry<Entity, Link>;
+
+	// every link targets a valid entity
+	bool consistent(Linked& reg) {
+		auto pipeline = reg.pipeline<const Entity, const Link>();
+		auto& entities = pipeline.pool<const Entity>();
+		auto& links = pipeline.pool<const Link>();
+
+		for (Entity e : links)
+		{
+			if (!entities.valid(e) || !entities.valid(links.getComponent(e).m_target))
+				return false;
+		}
+		return true;
+	}
+}
+
+int main()
+{
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "GawrConcurrentSave.snap";
+
+	Linked live;
+	Entity root;
+	{
+		auto pipeline = live.pipeline<Entity, Link>();
+		root = pipeline.pool<Entity>().create();
+		pipeline.pool<Link>().emplace(root, root);
+	}
+
+	// connected before the saver so it runs first, widening the window between release and the saver seeing the events
+	size_t slow;
+	{
+		auto pipeline = live.pipeline<const Entity>();
+		slow = pipeline.pool<const Entity>().on(Event::Construct).connect([](std::span<const Entity>) {
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		});
+	}
+
+	{
+		BackgroundSaver saver(live);
+
+		// each step creates a target and relinks root to it, root is already dirty from the step before
+		std::atomic<bool> stop = false;
+		std::jthread writer([&]()
+		{
+			while (!stop.load())
+			{
+				{
+					auto pipeline = live.pipeline<Entity, Link>();
+					Entity target = pipeline.pool<Entity>().create();
+					pipeline.pool<Link>().emplace(target, target);
+					pipeline.pool<Link>().emplace(root, target);
+				}
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+		});
+
+		Linked saved;
+		for (int i = 0; i < 200; i++)
+		{
+			saver.save(path);
+			saver.wait();
+
+			saved.load(path);
+			GAWR_CHECK(consistent(saved));
+		}
+
+		stop = true;
+	}
+
+	{
+		auto pipeline = live.pipeline<const Entity>();
+		pipeline.pool<const Entity>().on(Event::Construct).disconnect(slow);
+	}
+
+	std::filesystem::remove(path);
+	return EXIT_SUCCESS;
+}
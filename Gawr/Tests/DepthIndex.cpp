@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <vector>
+
+#include "Gawr/Components/Hierarchy.h"
+#include "Gawr/ECS/Index.h"
+#include "Check.h"
+
+// an index on a component written in place by an engine system, Parent::m_depth moved by setParent, clearParent and
+// updateHierarchy, must match the pool after each of them
+namespace {
+	using namespace Gawr::ECS;
+
+	struct DepthKey {
+		uint32_t operator()(const Parent& parent) const {
+			return parent.m_depth;
+		}
+	};
+
+	using DepthIndex = Index<Parent, DepthKey, Ordered>;
+
+	bool matches(Scene& scene, DepthIndex& index) {
+		auto pipeline = scene.pipeline<const Parent>();
+		auto& parentPool = pipeline.pool<const Parent>();
+
+		if (index.all(pipeline).size() != parentPool.size())
+			return false;
+
+		for (Entity e : parentPool)
+		{
+			auto found = index.find(pipeline, parentPool.getComponent(e).m_depth);
+			if (std::find(found.begin(), found.end(), e) == found.end())
+				return false;
+		}
+		return true;
+	}
+}
+
+int main()
+{
+	Scene scene;
+	std::vector<Entity> entities;
+	{
+		auto pipeline = scene.pipeline<Entity>();
+		for (int i = 0; i < 32; i++)
+			entities.push_back(pipeline.pool<Entity>().create());
+	}
+
+	{
+		// four chains of eight
+		auto pipeline = scene.pipeline<Parent, Children>();
+		for (size_t i = 0; i < entities.size(); i++)
+		{
+			if (i % 8 != 0)
+				setParent(pipeline, entities[i], entities[i - 1]);
+		}
+	}
+
+	std::unique_ptr<DepthIndex> index;
+	{
+		auto pipeline = scene.pipeline<const Parent>();
+		index = std::make_unique<DepthIndex>(pipeline);
+	}
+	GAWR_CHECK(matches(scene, *index));
+
+	// hanging the second chain under the end of the first moves every entity of it eight levels down
+	{
+		auto pipeline = scene.pipeline<Parent, Children>();
+		setParent(pipeline, entities[8], entities[7]);
+	}
+	GAWR_CHECK(matches(scene, *index));
+
+	{
+		auto pipeline = scene.pipeline<const Parent>();
+		GAWR_CHECK(index->find(pipeline, 14).size() == 1);
+		GAWR_CHECK(index->range(pipeline, 7, 15).size() == 8);
+	}
+
+	// cutting the middle of the first chain lifts the rest of it and the second chain back up
+	{
+		auto pipeline = scene.pipeline<Parent, Children>();
+		clearParent(pipeline, entities[4]);
+	}
+	GAWR_CHECK(matches(scene, *index));
+
+	// destroying a parent without its subtree leaves updateHierarchy to repair the depths
+	scene.destroy(std::vector<Entity>{ entities[17] });
+	updateHierarchy(scene);
+	GAWR_CHECK(matches(scene, *index));
+
+	index.reset();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+#include "Gawr/Components/Extraction.h"
+#include "Check.h"
+
+// the writer never waits: it skips the packets the render thread holds and, with too few slots, overwrites the oldest
+// published packet rather than a held one
+int main()
+{
+	using namespace Render;
+
+	// double buffer, a packet published while the render thread holds the other is overwritten by the next
+	{
+		FramePacketBuffer<> packets;
+		packets.beginWrite().m_frame = 1;
+		packets.publish();
+
+		const FramePacket* held = packets.acquire();
+		GAWR_CHECK(held && held->m_frame == 1);
+
+		packets.beginWrite().m_frame = 2;
+		packets.publish();
+		FramePacket& overwritten = packets.beginWrite();
+		GAWR_CHECK(&overwritten != held);
+		overwritten.m_frame = 3;
+		packets.publish();
+		packets.release();
+
+		const FramePacket* latest = packets.acquire();
+		GAWR_CHECK(latest && latest->m_frame == 3);
+		packets.release();
+
+		packets.close();
+		GAWR_CHECK(packets.acquire() == nullptr);
+	}
+
+	// five slots read two at a time, as the simulation does, never overwrite a held or one of the latest two packets
+	{
+		FramePacketBuffer<5, 2> packets;
+		auto none = packets.acquireLatest();
+		GAWR_CHECK(none[0] == nullptr && none[1] == nullptr);
+		packets.release();
+
+		for (uint64_t frame = 1; frame <= 2; frame++)
+		{
+			packets.beginWrite().m_frame = frame;
+			packets.publish();
+		}
+
+		// while the render thread holds two packets the writer publishes two more, the fifth slot is always free
+		for (uint64_t frame = 3; frame < 21; frame += 2)
+		{
+			auto held = packets.acquireLatest();
+			GAWR_CHECK(held[0]->m_frame == frame - 2 && held[1]->m_frame == frame - 1);
+
+			FramePacket& first = packets.beginWrite();
+			GAWR_CHECK(&first != held[0] && &first != held[1]);
+			first.m_frame = frame;
+			packets.publish();
+
+			FramePacket& second = packets.beginWrite();
+			GAWR_CHECK(&second != held[0] && &second != held[1] && &second != &first);
+			second.m_frame = frame + 1;
+			packets.publish();
+
+			packets.release();
+		}
+
+		auto latest = packets.acquireLatest();
+		GAWR_CHECK(latest[0]->m_frame == 19 && latest[1]->m_frame == 20);
+		packets.release();
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+#include <cstring>
+#include <vector>
+
+#include "Gawr/Components/Hierarchy.h"
+#include "Gawr/ECS/Delta.h"
+#include "Check.h"
+
+// the hierarchy and transform systems write components in place, a delta taken after them must reproduce their writes
+namespace {
+	using namespace Gawr::ECS;
+	using namespace Transform;
+
+	Entity createTransform(Scene& scene, glm::vec3 position) {
+		auto pipeline = scene.pipeline<Entity, Position, Rotation, Scale, Local, World, WorldPosition, WorldRotation, WorldScale, UpdateTag>();
+
+		Entity e = pipeline.pool<Entity>().create();
+		pipeline.pool<Position>().emplace(e, position);
+		pipeline.pool<Rotation>().emplace(e, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		pipeline.pool<Scale>().emplace(e, glm::vec3(1.0f));
+		pipeline.pool<Local>().emplace(e, glm::mat4(1.0f));
+		pipeline.pool<World>().emplace(e, glm::mat4(1.0f));
+		pipeline.pool<WorldPosition>().emplace(e, glm::vec3(0.0f));
+		pipeline.pool<WorldRotation>().emplace(e, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		pipeline.pool<WorldScale>().emplace(e, glm::vec3(1.0f));
+		pipeline.pool<UpdateTag>().emplace(e);
+		return e;
+	}
+
+	// same entities in every pool with byte equal components, pool order may differ after a delta
+	template<typename ... Ts>
+	bool same(Registry<Ts...>& lhs, Registry<Ts...>& rhs) {
+		auto a = lhs.template pipeline<const Ts...>();
+		auto b = rhs.template pipeline<const Ts...>();
+
+		return ([&]<typename U>()
+		{
+			auto& poolA = a.template pool<const U>();
+			auto& poolB = b.template pool<const U>();
+
+			if constexpr (std::is_same_v<U, Entity>)
+			{
+				size_t count = std::max(poolA.stats().m_sparse, poolB.stats().m_sparse);
+				for (Entity e = 0; e < count; e++)
+				{
+					if (poolA.valid(e) != poolB.valid(e))
+						return false;
+				}
+				return true;
+			}
+			else
+			{
+				if (poolA.size() != poolB.size())
+					return false;
+
+				for (Entity e : poolA)
+				{
+					if (!poolB.contains(e))
+						return false;
+
+					if constexpr (!std::is_empty_v<U>)
+					{
+						if (std::memcmp(&poolA.getComponent(e), &poolB.getComponent(e), sizeof(U)) != 0)
+							return false;
+					}
+				}
+				return true;
+			}
+		}.template operator()<Ts>() && ...);
+	}
+
+	void tag(Scene& scene, std::span<const Entity> entities) {
+		auto pipeline = scene.pipeline<UpdateTag>();
+		for (Entity e : entities)
+		{
+			if (!pipeline.pool<UpdateTag>().contains(e))
+				pipeline.pool<UpdateTag>().emplace(e);
+		}
+	}
+}
+
+int main()
+{
+	Scene live;
+	std::vector<Entity> entities;
+	for (int i = 0; i < 64; i++)
+		entities.push_back(createTransform(live, glm::vec3(float(i), 0.0f, 0.0f)));
+
+	{
+		// four chains of sixteen
+		auto pipeline = live.pipeline<Parent, Children>();
+		for (size_t i = 0; i < entities.size(); i++)
+		{
+			if (i % 16 != 0)
+				setParent(pipeline, entities[i], entities[i - 1]);
+		}
+	}
+	updateHierarchy(live);
+	updateLocalTransform(live);
+	updateWorldTransform(live);
+
+	Scene mirror;
+	DeltaRecorder recorder(live);
+	std::vector<std::byte> delta;
+	recorder.takeAll(delta);
+	mirror.applyDelta(delta);
+	GAWR_CHECK(same(live, mirror));
+
+	// reparent the middle of one chain under another, relinking siblings and moving the subtree's depths
+	{
+		auto pipeline = live.pipeline<Parent, Children>();
+		setParent(pipeline, entities[8], entities[20]);
+		setParent(pipeline, entities[40], entities[3]);
+		clearParent(pipeline, entities[50]);
+	}
+
+	{
+		auto pipeline = live.pipeline<Position>();
+		pipeline.pool<Position>().emplace(entities[0], glm::vec3(0.0f, 5.0f, 0.0f));
+	}
+
+	tag(live, entities);
+	updateLocalTransform(live);
+	updateWorldTransform(live);
+
+	mirror.applyDelta(recorder.take());
+	GAWR_CHECK(same(live, mirror));
+
+	// every transform technique, each after a reparent and a move
+	for (TransformMode mode : { TransformMode::Matrix, TransformMode::MatrixParallel, TransformMode::Hybrid })
+	{
+		{
+			auto pipeline = live.pipeline<Parent, Children, Position>();
+			setParent(pipeline, entities[8], entities[8 + 16 * (1 + int(mode))]);
+			pipeline.pool<Position>().emplace(entities[16], glm::vec3(float(mode), 1.0f, 0.0f));
+		}
+
+		tag(live, entities);
+		updateHierarchy(live);
+		updateLocalTransform(live);
+		updateWorldTransform(live, mode);
+
+		mirror.applyDelta(recorder.take());
+		GAWR_CHECK(same(live, mirror));
+	}
+
+	// destroying a parent without its subtree leaves the hierarchy to be repaired by updateHierarchy
+	live.destroy(std::vector<Entity>{ entities[33] });
+	updateHierarchy(live);
+
+	mirror.applyDelta(recorder.take());
+	GAWR_CHECK(same(live, mirror));
+
+	return EXIT_SUCCESS;
+}
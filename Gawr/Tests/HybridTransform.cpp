@@ -0,0 +1,49 @@
+#include <cstring>
+
+#include "Gawr/Components/Hierarchy.h"
+#include "Check.h"
+
+// the hybrid technique composes World from the world position, rotation and scale. an entity set up for the matrix path
+// has none of them and must keep its World when hybrid mode is selected
+int main()
+{
+	using namespace Gawr::ECS;
+	using namespace Transform;
+
+	glm::mat4 translation(1.0f);
+	translation[3] = glm::vec4(4.0f, 5.0f, 6.0f, 1.0f);
+
+	const World moved(translation);
+	const World identity(glm::mat4(1.0f));
+
+	Scene scene;
+	Entity matrix, hybrid;
+	{
+		auto pipeline = scene.pipeline<Entity, Position, Rotation, Scale, Local, World, WorldPosition, WorldRotation, WorldScale, UpdateTag>();
+
+		matrix = pipeline.pool<Entity>().create();
+		pipeline.pool<Local>().emplace(matrix, moved.m_matrix);
+		pipeline.pool<World>().emplace(matrix, moved.m_matrix);
+		pipeline.pool<UpdateTag>().emplace(matrix);
+
+		hybrid = pipeline.pool<Entity>().create();
+		pipeline.pool<Position>().emplace(hybrid, glm::vec3(1.0f, 2.0f, 3.0f));
+		pipeline.pool<Rotation>().emplace(hybrid, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		pipeline.pool<Scale>().emplace(hybrid, glm::vec3(1.0f));
+		pipeline.pool<World>().emplace(hybrid, identity.m_matrix);
+		pipeline.pool<WorldPosition>().emplace(hybrid, glm::vec3(0.0f));
+		pipeline.pool<WorldRotation>().emplace(hybrid, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		pipeline.pool<WorldScale>().emplace(hybrid, glm::vec3(1.0f));
+		pipeline.pool<UpdateTag>().emplace(hybrid);
+	}
+
+	updateHierarchy(scene);
+	updateWorldTransform(scene, TransformMode::Hybrid);
+
+	auto pipeline = scene.pipeline<const World>();
+	auto& worldPool = pipeline.pool<const World>();
+	GAWR_CHECK(std::memcmp(&worldPool.getComponent(matrix), &moved, sizeof(World)) == 0);
+	GAWR_CHECK(std::memcmp(&worldPool.getComponent(hybrid), &identity, sizeof(World)) != 0);
+
+	return EXIT_SUCCESS;
+}
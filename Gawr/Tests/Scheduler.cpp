@@ -0,0 +1,84 @@
+#include <chrono>
+#include <vector>
+
+#include "Gawr/ECS/Scheduler.h"
+#include "Check.h"
+
+// slices resume where the previous stopped, a starved system runs once it has waited maxWait frames and a skipped system
+// gains a priority level per frame waited
+int main()
+{
+	using namespace Gawr::ECS;
+	using namespace std::chrono_literals;
+	using steady_clock_t = std::chrono::steady_clock;
+
+	// an expired slice still visits one stride and resumes after it
+	{
+		std::vector<int> visits(1000, 0);
+		Slice slice{ 0, steady_clock_t::now() - 1s };
+
+		GAWR_CHECK(!sliceRange(slice, visits.size(), [&](size_t i) { visits[i]++; }));
+		GAWR_CHECK(slice.m_cursor == 64);
+
+		GAWR_CHECK(!sliceRange(slice, visits.size(), [&](size_t i) { visits[i]++; }));
+		GAWR_CHECK(slice.m_cursor == 128);
+
+		slice.m_deadline = steady_clock_t::now() + 1h;
+		GAWR_CHECK(sliceRange(slice, visits.size(), [&](size_t i) { visits[i]++; }));
+		GAWR_CHECK(slice.m_cursor == 0);
+
+		for (int count : visits)
+			GAWR_CHECK(count == 1);
+
+		// a cursor past a pool that shrank completes the pass
+		slice.m_cursor = 5000;
+		GAWR_CHECK(sliceRange(slice, visits.size(), [&](size_t) { }));
+	}
+
+	// with no frame budget every system is skipped until it has waited maxWait frames, then forced
+	{
+		Scheduler scheduler;
+		int runs = 0;
+		size_t id = scheduler.add("starved", [&](Slice&) { runs++; return true; }, 1ms, 0, 3);
+
+		for (int frame = 0; frame < 3; frame++)
+			scheduler.run(steady_clock_t::duration::zero());
+		GAWR_CHECK(runs == 0);
+		GAWR_CHECK(scheduler.stats(id).m_skipped == 3);
+
+		scheduler.run(steady_clock_t::duration::zero());
+		GAWR_CHECK(runs == 1);
+		GAWR_CHECK(scheduler.stats(id).m_forced == 1);
+		GAWR_CHECK(scheduler.stats(id).m_passes == 1 && scheduler.stats(id).m_framesPerPass == 4);
+
+		// the wait restarts after the forced slice
+		scheduler.run(steady_clock_t::duration::zero());
+		GAWR_CHECK(runs == 1);
+	}
+
+	// each system spends its whole slice, so only the first in a frame runs. the lower priority one overtakes once it has
+	// waited more frames than the difference in priority
+	{
+		Scheduler scheduler;
+		std::vector<char> order;
+		auto spin = [&](char name) {
+			return [&order, name](Slice& slice) {
+				order.push_back(name);
+				while (!slice.expired()) { }
+				return false;
+			};
+		};
+
+		scheduler.add("high", spin('h'), 1ms, 2, 100);
+		scheduler.add("low", spin('l'), 1ms, 0, 100);
+
+		for (int frame = 0; frame < 4; frame++)
+			scheduler.run(1ms);
+
+		// waits 1 and 2 do not pass priority 2, a tie keeps the order added, wait 3 does
+		GAWR_CHECK((order == std::vector<char>{ 'h', 'h', 'h', 'l' }));
+		GAWR_CHECK(scheduler.stats(1).m_skipped == 3 && scheduler.stats(1).m_forced == 0);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "Gawr/ECS/Registry.h"
+#include "Check.h"
+
+// once a stream of events has warmed up the signal's buffers, writing, taking and dispatching a batch allocates nothing
+namespace {
+	std::atomic<size_t> allocations = 0;
+}
+
+void* operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+
+int main()
+{
+	using namespace Gawr::ECS;
+
+	struct Health { float m_value; };
+	using Registry_T = Registry<Entity, Health>;
+
+	Registry_T reg;
+	{
+		auto pipeline = reg.pipeline<Entity, Health>();
+		for (int i = 0; i < 512; i++)
+			pipeline.pool<Health>().emplace(pipeline.pool<Entity>().create(), float(i));
+	}
+
+	size_t dispatched = 0;
+	size_t handle;
+	{
+		auto pipeline = reg.pipeline<const Health>();
+		handle = pipeline.pool<const Health>().on(Event::Update).connect([&](std::span<const Entity> entities) { dispatched += entities.size(); });
+	}
+
+	auto frame = [&](int count)
+	{
+		auto pipeline = reg.pipeline<Health>();
+		auto& healthPool = pipeline.pool<Health>();
+		for (Entity e = 0; e < Entity(count); e++)
+		{
+			healthPool.getComponent(e).m_value += 1.0f;
+			healthPool.update(e);
+		}
+	};
+
+	// the largest frame first so later frames fit the recycled buffers
+	for (int i = 0; i < 4; i++)
+		frame(512);
+
+	size_t before = allocations.load();
+	for (int i = 0; i < 100; i++)
+		frame(64 + i * 4);
+
+	GAWR_CHECK(allocations.load() == before);
+	GAWR_CHECK(dispatched == 4 * 512 + 100 * 64 + 4 * (99 * 100 / 2));
+
+	{
+		auto pipeline = reg.pipeline<const Health>();
+		pipeline.pool<const Health>().on(Event::Update).disconnect(handle);
+	}
+	return EXIT_SUCCESS;
+}
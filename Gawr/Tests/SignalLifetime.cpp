@@ -0,0 +1,53 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "Gawr/Components/Hierarchy.h"
+#include "Gawr/ECS/Collector.h"
+#include "Check.h"
+
+// a collector destroyed while another thread dispatches a batch taken before the disconnect must not be called after
+int main()
+{
+	using namespace Gawr::ECS;
+	using Collector_T = Collector<Where<AllOf<Parent>>>;
+
+	Scene scene;
+	{
+		auto pipeline = scene.pipeline<Entity>();
+		for (int i = 0; i < 1024; i++)
+			pipeline.pool<Entity>().create();
+	}
+
+	std::atomic<bool> stop = false;
+	std::jthread writer([&]()
+	{
+		for (Entity e = 0; !stop; e = (e + 1) % 1024)
+		{
+			auto pipeline = scene.pipeline<Parent>();
+			auto& parentPool = pipeline.pool<Parent>();
+			if (parentPool.contains(e))
+				parentPool.remove(e);
+			else
+				parentPool.emplace(e, Parent{ 0 });
+		}
+	});
+
+	size_t collected = 0;
+	for (int i = 0; i < 2000; i++)
+	{
+		std::unique_ptr<Collector_T> collector;
+		{
+			auto pipeline = scene.pipeline<const Parent>();
+			collector = std::make_unique<Collector_T>(pipeline);
+		}
+
+		std::this_thread::yield();
+		collected += collector->size();
+		collector.reset();
+	}
+
+	stop = true;
+	GAWR_CHECK(collected > 0);
+	return EXIT_SUCCESS;
+}
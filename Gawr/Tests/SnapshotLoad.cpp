@@ -0,0 +1,169 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "Gawr/ECS/Registry.h"
+#include "Check.h"
+
+// a snapshot that is truncated or holds an index out of range must throw from load and leave every pool as it was, even
+// the pools read before the corrupt one. the writer must throw rather than overrun its headers
+namespace {
+	using namespace Gawr::ECS;
+
+	struct Health { float m_value; };
+	struct Follows { float m_weight; };
+
+	using TestRegistry = Registry<Entity, Health, Relation<Follows>>;
+
+	std::vector<char> readFile(const std::filesystem::path& path) {
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void writeFile(const std::filesystem::path& path, const std::vector<char>& bytes) {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(bytes.data(), bytes.size());
+	}
+
+	internal::PoolHeader poolHeader(const std::vector<char>& bytes, size_t pool) {
+		internal::PoolHeader header;
+		std::memcpy(&header, bytes.data() + sizeof(internal::FileHeader) + pool * sizeof(internal::PoolHeader), sizeof(header));
+		return header;
+	}
+
+	// overwrites the first value of a section
+	template<typename T>
+	std::vector<char> corrupt(std::vector<char> bytes, size_t pool, size_t section, T value) {
+		std::memcpy(bytes.data() + poolHeader(bytes, pool).m_section[section].m_offset, &value, sizeof(T));
+		return bytes;
+	}
+
+	void populate(TestRegistry& world, size_t count, float health) {
+		auto pipeline = world.pipeline<Entity, Health, Relation<Follows>>();
+		std::vector<Entity> entities;
+		for (size_t i = 0; i < count; i++)
+		{
+			Entity e = pipeline.pool<Entity>().create();
+			pipeline.pool<Health>().emplace(e, health + float(i));
+			if (!entities.empty())
+				pipeline.pool<Relation<Follows>>().emplace(e, entities.back(), float(i));
+			entities.push_back(e);
+		}
+	}
+
+	bool matches(TestRegistry& world, size_t count, float health) {
+		auto pipeline = world.pipeline<const Entity, const Health, const Relation<Follows>>();
+		auto& entities = pipeline.pool<const Entity>();
+		auto& healths = pipeline.pool<const Health>();
+		auto& follows = pipeline.pool<const Relation<Follows>>();
+
+		if (entities.stats().m_count != count || healths.size() != count || follows.pairCount() != count - 1)
+			return false;
+
+		for (Entity e = 0; e < count; e++)
+		{
+			if (!entities.valid(e) || healths.getComponent(e).m_value != health + float(e))
+				return false;
+			if (e > 0 && follows.getRelation(e, e - 1).m_weight != float(e))
+				return false;
+		}
+		return true;
+	}
+
+	template<typename Func_T>
+	bool throws(Func_T func) {
+		try
+		{
+			func();
+		}
+		catch (const std::runtime_error&)
+		{
+			return true;
+		}
+		return false;
+	}
+}
+
+int main()
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path();
+	std::filesystem::path saved = directory / "GawrSnapshotLoad.snap";
+	std::filesystem::path corrupted = directory / "GawrSnapshotLoadCorrupt.snap";
+
+	{
+		TestRegistry source;
+		populate(source, 32, 100.0f);
+		source.save(saved);
+	}
+
+	TestRegistry world;
+	populate(world, 8, 0.0f);
+
+	world.load(saved);
+	GAWR_CHECK(matches(world, 32, 100.0f));
+
+	TestRegistry other;
+	populate(other, 8, 0.0f);
+	std::vector<char> bytes = readFile(saved);
+
+	// the last section is cut short, so the relation pool fails after the handles and health were read
+	std::vector<char> truncated = bytes;
+	truncated.resize(poolHeader(bytes, 2).m_section[0].m_offset + 1);
+	writeFile(corrupted, truncated);
+	GAWR_CHECK(throws([&] { other.load(corrupted); }));
+	GAWR_CHECK(matches(other, 8, 0.0f));
+
+	// health's first packed entity is past its sparse array
+	writeFile(corrupted, corrupt(bytes, 1, 1, Entity{ 1u << 20 }));
+	GAWR_CHECK(throws([&] { other.load(corrupted); }));
+	GAWR_CHECK(matches(other, 8, 0.0f));
+
+	// health's first sparse entry indexes past the packed array
+	writeFile(corrupted, corrupt(bytes, 1, 0, size_t{ 1000 }));
+	GAWR_CHECK(throws([&] { other.load(corrupted); }));
+	GAWR_CHECK(matches(other, 8, 0.0f));
+
+	// the first pair's subject is past the node array
+	writeFile(corrupted, corrupt(bytes, 2, 0, Entity{ 1u << 20 }));
+	GAWR_CHECK(throws([&] { other.load(corrupted); }));
+	GAWR_CHECK(matches(other, 8, 0.0f));
+
+	// the first handle links past the node array
+	writeFile(corrupted, corrupt(bytes, 0, 0, std::ptrdiff_t{ 1 } << 40));
+	GAWR_CHECK(throws([&] { other.load(corrupted); }));
+	GAWR_CHECK(matches(other, 8, 0.0f));
+
+	// a section past the end of the file
+	std::vector<char> moved = bytes;
+	internal::PoolHeader header = poolHeader(bytes, 1);
+	header.m_section[0].m_offset = ~uint64_t{ 0 } - 8;
+	std::memcpy(moved.data() + sizeof(internal::FileHeader) + sizeof(internal::PoolHeader), &header, sizeof(header));
+	writeFile(corrupted, moved);
+	GAWR_CHECK(throws([&] { other.load(corrupted); }));
+	GAWR_CHECK(matches(other, 8, 0.0f));
+
+	other.load(saved);
+	GAWR_CHECK(matches(other, 32, 100.0f));
+
+	// the writer refuses to overrun the fixed arrays of the headers rather than corrupt them
+	{
+		SnapshotWriter writer(corrupted, 1);
+		std::vector<uint32_t> values{ 1, 2, 3 };
+
+		GAWR_CHECK(throws([&] { writer.scalar(0); }));
+		writer.beginPool<Health>();
+		for (size_t i = 0; i < internal::maxSections; i++)
+			writer.array<uint32_t>(values);
+		for (size_t i = 0; i < internal::maxScalars; i++)
+			writer.scalar(i);
+
+		GAWR_CHECK(throws([&] { writer.array<uint32_t>(values); }));
+		GAWR_CHECK(throws([&] { writer.scalar(0); }));
+		GAWR_CHECK(throws([&] { writer.beginPool<Follows>(); }));
+	}
+
+	std::filesystem::remove(saved);
+	std::filesystem::remove(corrupted);
+	return EXIT_SUCCESS;
+}
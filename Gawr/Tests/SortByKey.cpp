@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Gawr/ECS/Registry.h"
+#include "Check.h"
+
+// sortByKey must order by key with equal keys in their previous iteration order, for signed keys through the sign flip,
+// for bool keys and for pools large enough that the radix sort runs in several chunks
+namespace {
+	using namespace Gawr::ECS;
+
+	struct Item {
+		int64_t		m_key;
+		Entity		m_entity;
+		uint32_t	m_sequence;	// position in iteration order before the sort
+		bool		m_visible;
+	};
+
+	using Items = Registry<Entity, Item>;
+
+	void fill(Items& items, size_t count) {
+		auto pipeline = items.pipeline<Entity, Item>();
+		for (size_t i = 0; i < count; i++)
+		{
+			Entity e = pipeline.pool<Entity>().create();
+			int64_t key = int64_t(i * 7919 % 13) - 6;	// negative, zero and positive, many duplicates
+			if (i % 1000 == 0)
+				key = i % 2000 ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+
+			pipeline.pool<Item>().emplace(e, Item{ key, e, 0, i % 3 == 0 });
+		}
+	}
+
+	void number(Items& items) {
+		auto pipeline = items.pipeline<Item>();
+		uint32_t sequence = 0;
+		for (Entity e : pipeline.pool<Item>())
+			pipeline.pool<Item>().getComponent(e).m_sequence = sequence++;
+	}
+
+	// keys ascending and equal keys in their previous order
+	template<typename KeyFn_T>
+	bool sortedStable(Items& items, KeyFn_T keyFn) {
+		auto pipeline = items.pipeline<const Item>();
+		const Item* prev = nullptr;
+		for (Entity e : pipeline.pool<const Item>())
+		{
+			const Item& item = pipeline.pool<const Item>().getComponent(e);
+			if (prev && (keyFn(item) < keyFn(*prev) || (keyFn(item) == keyFn(*prev) && item.m_sequence < prev->m_sequence)))
+				return false;
+			prev = &item;
+		}
+		return true;
+	}
+
+	template<typename KeyFn_T>
+	void check(size_t count, KeyFn_T keyFn) {
+		Items items;
+		fill(items, count);
+		number(items);
+
+		{
+			auto pipeline = items.pipeline<Item>();
+			pipeline.pool<Item>().sortByKey(keyFn);
+		}
+		GAWR_CHECK(sortedStable(items, keyFn));
+
+		// each entity still holds its own component
+		auto pipeline = items.pipeline<const Item>();
+		GAWR_CHECK(pipeline.pool<const Item>().size() == count);
+		for (Entity e : pipeline.pool<const Item>())
+			GAWR_CHECK(pipeline.pool<const Item>().getComponent(e).m_entity == e);
+	}
+}
+
+int main()
+{
+	// the radix sort split into more chunks than this machine may have threads, equal keys keep their order across chunks
+	{
+		std::vector<uint32_t> keys(10007);
+		std::vector<uint32_t> values(keys.size());
+		for (uint32_t i = 0; i < keys.size(); i++)
+		{
+			keys[i] = (i * 2654435761u) % 97 * 0x01010101u;	// every byte a digit, 97 distinct keys
+			values[i] = i;
+		}
+
+		std::vector<uint32_t> expected = values;
+		std::stable_sort(expected.begin(), expected.end(), [&](uint32_t lhs, uint32_t rhs) { return keys[lhs] < keys[rhs]; });
+
+		internal::radixSort(keys, values, 4);
+		GAWR_CHECK(values == expected);
+		GAWR_CHECK(std::is_sorted(keys.begin(), keys.end()));
+	}
+
+	// small pools sort in one chunk, large ones in one chunk per thread
+	for (size_t count : { size_t{ 100 }, size_t{ 100000 } })
+	{
+		check(count, [](const Item& item) { return item.m_key; });
+		check(count, [](const Item& item) { return int8_t(item.m_key); });
+		check(count, [](const Item& item) { return uint16_t(item.m_key); });
+		check(count, [](const Item& item) { return item.m_visible; });
+		check(count, [](const Item& item) { return double(item.m_key); });
+	}
+
+	// a second sort by another key keeps the first order within equal keys
+	Items items;
+	fill(items, 50000);
+	{
+		auto pipeline = items.pipeline<Item>();
+		pipeline.pool<Item>().sortByKey([](const Item& item) { return item.m_key; });
+	}
+	number(items);
+	{
+		auto pipeline = items.pipeline<Item>();
+		pipeline.pool<Item>().sortByKey([](const Item& item) { return item.m_visible; });
+	}
+	GAWR_CHECK(sortedStable(items, [](const Item& item) { return item.m_visible; }));
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,69 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "Gawr/ECS/Registry.h"
+#include "Gawr/ECS/StreamingLoader.h"
+#include "Check.h"
+
+// destroying a loader abandons the requests no worker has started, only the chunk being decoded is finished
+namespace {
+	std::atomic<int> decoded = 0;
+
+	// decoding is slow and counted, so the test sees which requests were started. not trivially copyable so it is
+	// decoded through its Serializer
+	struct Counted {
+		int m_value;
+
+		Counted(int value) : m_value(value) { }
+		Counted(const Counted& other) : m_value(other.m_value) { }
+		Counted& operator=(const Counted& other) { m_value = other.m_value; return *this; }
+	};
+}
+
+template<>
+struct Gawr::ECS::Serializer<Counted> {
+	static void save(ByteWriter& writer, const Counted& value) {
+		writer.write(value.m_value);
+	}
+
+	static Counted load(ByteReader& reader) {
+		decoded++;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		return { reader.read<int>() };
+	}
+};
+
+int main()
+{
+	using namespace Gawr::ECS;
+	using Registry_T = Registry<Entity, Counted>;
+
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "GawrStreamingShutdown.snapshot";
+	{
+		Registry_T chunk;
+		{
+			auto pipeline = chunk.pipeline<Entity, Counted>();
+			pipeline.pool<Counted>().emplace(pipeline.pool<Entity>().create(), Counted{ 7 });
+		}
+		chunk.save(path);
+	}
+
+	constexpr int requests = 100;
+	Registry_T live;
+	{
+		StreamingLoader<Entity, Counted> loader(live, 1);
+		for (int i = 0; i < requests; i++)
+			loader.request(path);
+
+		// let the worker start the first chunk
+		auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (decoded == 0 && std::chrono::steady_clock::now() < timeout)
+			std::this_thread::yield();
+	}
+
+	GAWR_CHECK(decoded >= 1 && decoded <= 2);
+	std::filesystem::remove(path);
+	return EXIT_SUCCESS;
+}
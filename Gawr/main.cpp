@@ -1,8 +1,10 @@
 #include <random>
 #include <iostream>
+#include <string>
 
 #include "Gawr/Components/Hierarchy.h"
 #include "Graphics.h"
+#include "Benchmark.h"
 #include "Gawr/Scene.h"
 //#include "Gawr/Core/Context.h"
 //#include "Gawr/Core/Window.h"
@@ -14,9 +16,16 @@ struct D { int d; };
 
 
 
-int main() 
+int main(int argc, char** argv) 
 {
 	using namespace Gawr::ECS;
+
+	if (argc > 1 && std::string(argv[1]) == "--benchmark")
+	{
+		Benchmark::transforms(std::cout);
+		Benchmark::extraction(std::cout);
+		return 0;
+	}
 	
 	Registry<A, B, C, D> reg;
 	auto pip = reg.pipeline<Entity>();